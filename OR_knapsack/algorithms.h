@@ -8,6 +8,11 @@
 #include <string>
 #include <algorithm>
 #include <memory>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include "ortools/linear_solver/linear_solver.h"
 
 
@@ -20,6 +25,7 @@ namespace KP // knapsack
 
 	public:
 		void set_on(bool on) { _on = on; }
+		bool is_on() const { return _on; }
 		friend Output& operator<<(Output& output, const std::string& msg);
 		friend Output& operator<<(Output& output, const char* msg);
 		friend Output& operator<<(Output& output, long unsigned int value);
@@ -42,6 +48,143 @@ namespace KP // knapsack
 
 	///////////////////////////////////////////////////////////////////////////
 
+	// Items toggled with respect to a reference solution, stored as a linked list of records with parent pointers.
+	// Used by the state-based algorithms to reconstruct a solution without copying it into every state.
+	class ToggleTrail
+	{
+		struct Record
+		{
+			int item;
+			int parent; // -1 if this is the first record
+		};
+		std::vector<Record> _records;
+		size_t _compacted_size = 0;
+
+	public:
+		void clear() { _records.clear(); _compacted_size = 0; }
+		int add(int item, int parent);
+		size_t size() const { return _records.size(); }
+
+		// Apply the items toggled by record 'rec' to 'solution' (1 - x)
+		void apply(int rec, std::vector<int>& solution) const;
+
+		// Remove all records that cannot be reached from 'roots', which are updated to the new indices
+		bool needs_compaction() const { return _records.size() > 2 * _compacted_size + (1 << 20); }
+		void compact(std::vector<int>& roots);
+
+		// The same with the member 'trail' of the states and 'best' as the roots
+		template <class State>
+		void compact(std::vector<State>& states, int& best)
+		{
+			std::vector<int> roots;
+			roots.reserve(states.size() + 1);
+			for (auto&& state : states)
+				roots.push_back(state.trail);
+			roots.push_back(best);
+			compact(roots);
+			for (size_t i = 0; i < states.size(); ++i)
+				states[i].trail = roots[i];
+			best = roots.back();
+		}
+
+		template <class State>
+		void compact(std::vector<std::vector<State>>& buckets, int& best)
+		{
+			std::vector<int> roots;
+			for (auto&& bucket : buckets)
+				for (auto&& state : bucket)
+					roots.push_back(state.trail);
+			roots.push_back(best);
+			compact(roots);
+			size_t k = 0;
+			for (auto&& bucket : buckets)
+				for (auto&& state : bucket)
+					state.trail = roots[k++];
+			best = roots.back();
+		}
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// State of the dynamic programs over the undominated (profit, weight) pairs, its items are stored in a ToggleTrail
+	struct TrailState
+	{
+		int64_t profit;
+		int64_t weight;
+		int trail; // last record in the trail, -1 for the reference solution
+	};
+
+	// Merge 'states' with the states in which item j is toggled (profit + dp, weight + dw) into 'merged', only the toggled
+	// states with a weight up to 'max_weight' are used. Both lists are sorted by weight, so a state is dominated if and
+	// only if an earlier state in the merged list has at least the same profit; 'merged' has strictly increasing profits.
+	void merge_states(const std::vector<TrailState>& states, int j, int64_t dp, int64_t dw, int64_t max_weight,
+		ToggleTrail& trail, std::vector<TrailState>& merged);
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Prefix sums of the values and weights of the items sorted by efficiency, so that the break item of the
+	// LP relaxation is found by binary search instead of walking over the items. Items can be skipped (fixed by
+	// branching), the sums of the other items are kept in Fenwick trees so that skipping costs O(log n) as well.
+	class LPBound
+	{
+		std::vector<int64_t> _value; // [j] = value of the items [0, j)
+		std::vector<int64_t> _weight; // [j] = weight of the items [0, j)
+		std::vector<int64_t> _tree_value; // Fenwick trees of the items that are not skipped
+		std::vector<int64_t> _tree_weight;
+
+		void update(size_t j, int64_t value, int64_t weight);
+
+	public:
+		void build(const std::vector<Item>& items);
+
+		// Upper bound for the items [first, n) with the given capacity (rounded down), skipped items included
+		int64_t add_bound(size_t first, int64_t capacity) const;
+
+		// Lower bound for the value lost by removing items [0, last) to free 'excess' weight (rounded up),
+		// the least efficient items are removed first; returns -1 if the items [0, last) weigh less than 'excess'
+		int64_t remove_bound(size_t last, int64_t excess) const;
+
+		// Break item of the items that are not skipped for the given capacity, 'value' and 'weight' are the totals
+		// of these items before the break item; returns n if all of them fit
+		size_t break_item(int64_t capacity, int64_t& value, int64_t& weight) const;
+		void skip(size_t j, const Item& item) { update(j, -item.value, -item.weight); }
+		void restore(size_t j, const Item& item) { update(j, item.value, item.weight); }
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Row updates of the dynamic programs over the capacity, with the widest vector instructions of the processor
+	// (found with cpuid on the first use) and a scalar version for other processors.
+	class RowKernels
+	{
+	public:
+		enum class InstructionSet
+		{
+			scalar,
+			sse4, // SSE4.2: 2 profits at a time
+			avx2, // 4 profits at a time
+			avx512, // AVX-512F: 8 profits at a time
+		};
+
+		static InstructionSet supported(); // widest instruction set of the processor
+		static InstructionSet instruction_set();
+		static void set_instruction_set(const std::string& name); // "scalar", "sse4", "avx2" or "avx512", if supported
+		static const char* name(InstructionSet instruction_set);
+
+		// profits[c] = max(profits[c], profits[c - w] + p) for c = w .. capacity, bit c of 'take' is set if profits[c]
+		// improves ('take' can be nullptr)
+		static void add_item(int64_t* profits, int64_t capacity, const Item& item, uint64_t* take);
+
+		// the same as add_item for 'first' and then for 'second', in one pass over the row
+		static void add_items(int64_t* profits, int64_t capacity, const Item& first, const Item& second);
+
+		// bits |= bits << shift for the words [0, nb_words) of a bitset, new_bits[i] = the bits of word i that are set
+		// by the shift ('new_bits' can be nullptr)
+		static void shift_or(uint64_t* bits, size_t nb_words, int64_t shift, uint64_t* new_bits);
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
 	// Base class
 	class Algorithm
 	{
@@ -54,6 +197,23 @@ namespace KP // knapsack
 		int64_t _best_value = std::numeric_limits<int64_t>::max();
 		std::vector<int> _best_solution; // [i] == 1 if item i added to knapsack, 0 otherwise
 
+		bool is_subset_sum() const; // value == weight for all items
+		bool is_strongly_correlated() const; // value == weight + k for all items, with the same constant k
+		int64_t dantzig_bound() const; // upper bound of the LP relaxation, rounded down
+
+		void sort_by_efficiency() { sort_by_efficiency(0, _items.size()); }
+		void sort_by_efficiency(size_t first, size_t last); // only the items [first, last)
+		size_t find_break_item(int64_t& valuesum, int64_t& weightsum) const; // returns _items.size() if all items fit
+
+		// [c] = best profit of the items [first, last) with capacity c, for c = 0 .. capacity
+		void best_profits(size_t first, size_t last, int64_t capacity, std::vector<int64_t>& profits) const;
+		// optimal solution of the items [first, last) with the given capacity in _best_solution (0 for these items),
+		// by divide and conquer over the items (Hirschberg) in O(n C) time and O(C) memory
+		void recover_solution(size_t first, size_t last, int64_t capacity);
+		void divide_and_conquer(size_t first, size_t last, int64_t capacity, std::vector<int64_t>& forward, std::vector<int64_t>& backward);
+
+		friend class AlgorithmFactory;
+
 	public:
 		virtual ~Algorithm() {}
 
@@ -67,16 +227,142 @@ namespace KP // knapsack
 
 	class CompleteEnumeration : public Algorithm
 	{
+	public:
+		enum class Mode
+		{
+			all_subsets, // recursion over all 2^n subsets
+			meet_in_the_middle, // Horowitz and Sahni: the subsets of both halves are combined
+			schroeppel_shamir, // the sums of both halves are generated in order from the subsets of four quarters
+			gray_code, // iterative over all 2^n subsets in Gray-code order, in parallel over ranges with fixed last items
+		};
+
+	private:
+		struct Subset
+		{
+			int64_t profit;
+			int64_t weight;
+			uint64_t items; // bit j - first is set if item j is selected
+		};
+
+		Mode _mode = Mode::all_subsets;
+		size_t _threads = 0; // threads of the Gray-code enumeration
+
 		void complete_enumeration_imp(std::vector<int>& sequence);
+		std::vector<Subset> enumerate_subsets(size_t first, size_t last);
+		void meet_in_the_middle();
+		void schroeppel_shamir();
+		void gray_code();
 
 	public:
 		void run(bool verbose) override;
+		void set_mode(Mode mode) { _mode = mode; }
+		void set_threads(size_t threads) { _threads = threads; } // 0 = all processor cores
 	};
 
 	///////////////////////////////////////////////////////////////////////////
 
 	class BranchAndBound : public Algorithm
 	{
+	public:
+		enum class Mode
+		{
+			depth_first, // the last node created is explored first
+			best_first, // the node with the highest upper bound is explored first, depth-first if the memory limit is reached
+		};
+
+	private:
+		// In the LP relaxation the free items before 'breakitem' are in the knapsack, 'breakitem' is the first free item
+		// that doesn't fit. It is found in O(log n) with the prefix sums of the free items in _lp_bound.
+		struct LP
+		{
+			size_t breakitem;
+			int64_t fixed_value, fixed_weight; // items fixed to 1
+			int64_t free_value, free_weight; // free items before the break item
+		};
+
+		// Undo trail: fixing an item stores the LP before the item was fixed
+		struct Record
+		{
+			size_t item;
+			LP lp;
+		};
+
+		// Node of the depth-first search: the item it fixes and the size of the undo trail of its parent,
+		// going back to the parent only restores the records of the undo trail
+		struct Node
+		{
+			size_t item;
+			bool x;
+			size_t trail_size;
+		};
+
+		// The fixed path of an open node of the best-first search is a linked list of records with parent pointers,
+		// shared by the nodes with the same ancestors. Records that are no longer referenced are recycled.
+		struct PathRecord
+		{
+			size_t item;
+			bool x;
+			int parent; // -1 if this is the first record
+			int references; // open nodes and child records pointing to this record
+		};
+
+		// State of one search: the fixed items, the LP relaxation and the undo trail. Every thread of the parallel
+		// search has its own, the stack is a deque of which the other threads steal the first (least deep) node.
+		struct Search
+		{
+			std::vector<int> items_fixed; // -1 = free, 0 or 1 = fixed value
+			LPBound lp_bound;
+			LP lp;
+			std::vector<Record> trail;
+			std::vector<Node> stack; // nodes [bottom, size) are open
+			size_t bottom = 0;
+			std::vector<std::pair<size_t, bool>> stolen_path; // items fixed by the last stolen node
+			std::atomic<size_t> nodes_explored = 0;
+			std::mutex mutex; // stack and trail, which are read by the threads that steal from this search
+		};
+
+		Mode _mode = Mode::depth_first;
+		size_t _memory_limit = size_t(1) << 30; // bytes for the open nodes of the best-first search
+		size_t _threads = 1; // threads of the depth-first search
+		int64_t _global_bound; // upper bound of all open nodes
+		std::chrono::system_clock::time_point _last_report;
+		Output _progress; // always on, for the reports of the gap
+
+		std::vector<std::unique_ptr<Search>> _searches;
+		std::atomic<int64_t> _incumbent; // _best_value, shared by the threads
+		std::mutex _solution_mutex; // _best_solution
+		std::atomic<size_t> _busy; // threads with open nodes
+		std::vector<PathRecord> _path;
+		std::vector<int> _free_path; // recycled records of _path
+
+		void fix(Search& search, size_t item, bool x);
+		void undo(Search& search, size_t trail_size);
+		int add_path(size_t item, bool x, int parent);
+		void release_path(int rec);
+		bool evaluate(Search& search, int64_t& upper_bound); // returns true if the node has to be branched on lp.breakitem
+		void depth_first(Search& search, size_t item);
+		void best_first(size_t item, int64_t upper_bound);
+		void parallel_depth_first(size_t item);
+		void work(size_t thread);
+		bool steal(size_t thread);
+		size_t nodes_explored() const;
+		void report(bool always);
+
+	public:
+		void run(bool verbose) override;
+		void set_mode(Mode mode) { _mode = mode; }
+		void set_memory_limit(size_t bytes) { _memory_limit = bytes; }
+		void set_threads(size_t threads) { _threads = threads; } // 0 = all processor cores
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Depth-first branch-and-bound of Horowitz and Sahni: forward moves add the items in order of efficiency
+	// as long as they fit, backtracking removes the last added item, so every node takes O(1) memory
+	class HorowitzSahni : public Algorithm
+	{
+		size_t _nodes_explored;
+
 	public:
 		void run(bool verbose) override;
 	};
@@ -87,10 +373,218 @@ namespace KP // knapsack
 	{
 		int64_t det(size_t a, size_t b, size_t c, size_t d) { return a * d - b * c; }
 
+		// Node of the branching: the solution of the break item with the items [s+1, t) changed. Items j >= t
+		// are added below capacity, items j <= s are removed above capacity. 'item' is the item changed in the child,
+		// t if it is added and -s if it is removed, which orders the children in the depth-first search.
+		struct Frame
+		{
+			int64_t P, W;
+			int64_t s, t;
+			int64_t item;
+		};
+
+		struct Search
+		{
+			std::vector<Frame> frames; // [d] = node at depth d of the current path
+			std::vector<int> path; // items changed on the path to frames[0]
+			std::vector<int> position; // path to the current node
+			int64_t best_value; // best solution of this search
+			int64_t lower_bound; // nodes with an upper bound <= lower_bound are pruned
+			size_t incumbent_version; // version of the incumbent of lower_bound
+			size_t nodes_explored = 0;
+		};
+
+		// Parallel branching: the nodes at depth _split_depth are subproblems that are explored by the threads
+		struct Subproblem
+		{
+			Frame root;
+			std::vector<int> path;
+		};
+
+		size_t _threads = 1;
+		size_t _split_depth = 4;
+		Search _search;
+		std::vector<int> _exceptions; // items changed in the best solution with respect to the break solution
+		LPBound _lp_bound; // only if all items are sorted
+
+		// Incumbent shared by the threads, with the path to its node. Of the solutions with the best value the first
+		// one in the depth-first search is kept, so that the solution doesn't depend on the threads.
+		std::atomic<int64_t> _incumbent;
+		std::atomic<size_t> _incumbent_version;
+		std::vector<int> _incumbent_path;
+		std::mutex _mutex; // incumbent and queue
+		std::condition_variable _queue_changed;
+		std::deque<Subproblem> _queue;
+		size_t _queue_limit; // the subproblems are created when the threads need them
+		bool _splitting; // subproblems are still created
+
+		// the nodes at depth 'split_depth' (> 0) are stored in _queue instead of explored
+		void branching(Search& search, int64_t P, int64_t W, int64_t s, int64_t t, size_t split_depth);
+		void parallel_branching(int64_t P, int64_t W, int64_t s, int64_t t, size_t nb_threads);
+		void improve(Search& search, int64_t value);
+		void update_lower_bound(Search& search);
+
+		// Expanding core (expknap): only the items [_core_first, _core_last) are sorted,
+		// the other items are kept in intervals that are sorted when the branching reaches them
+		struct Interval
+		{
+			size_t first;
+			size_t last;
+		};
+		bool _expanding_core = false;
+		std::vector<Interval> _left_intervals; // back() is adjacent to the core
+		std::vector<Interval> _right_intervals; // back() is adjacent to the core
+		size_t _core_first;
+		size_t _core_last;
+
+		size_t partial_sort(int64_t& valuesum, int64_t& weightsum);
+		void expand_core(int64_t j);
+
+	public:
+		void run(bool verbose) override;
+		void set_expanding_core(bool expanding_core) { _expanding_core = expanding_core; }
+		void set_threads(size_t threads) { _threads = threads; } // 0 = all processor cores, not with an expanding core
+		void set_split_depth(size_t depth) { _split_depth = depth; }
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Branch-and-bound algorithm MT2 of Martello and Toth: the problem is first solved for an approximate core
+	// around the critical item, then the items outside the core are fixed with the reduction procedure, and
+	// the reduced problem is solved with the depth-first branch-and-bound MT1 using the upper bound U2
+	class MT2 : public Algorithm
+	{
 		size_t _nodes_explored;
-		std::list<int> _exceptions;
 
-		bool branching(int64_t P, int64_t W, int64_t s, int64_t t);
+		size_t find_critical_item(int64_t& valuesum, int64_t& weightsum);
+		int64_t mt1(const std::vector<size_t>& items, int64_t capacity, int64_t lower_bound, std::vector<int>& solution);
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Expanding core dynamic programming of Pisinger (minknap)
+	class Minknap : public Algorithm
+	{
+	protected:
+		using State = TrailState; // trail == -1 for the break solution
+
+		std::vector<State> _states;
+		std::vector<State> _buffer;
+		ToggleTrail _trail;
+		int _best_trail;
+
+		int64_t _upper_bound;
+		size_t _max_states;
+
+		void merge(size_t j, bool add);
+		void reduce(int64_t s, int64_t t);
+		void solve(const std::string& name);
+
+		// called every time the number of states doubles, core = [s+1, t-1]
+		virtual void tighten_bounds(int64_t, int64_t) {}
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	class Combo : public Minknap
+	{
+		void pairing(int64_t s, int64_t t);
+		int64_t surrogate_bound();
+		void tighten_bounds(int64_t s, int64_t t) override;
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Balanced dynamic programming of Pisinger (balsub): starting from the break solution, items after the break item
+	// are only inserted while the weight is at most C, and items before it are only removed while the weight exceeds C,
+	// so that all states have a weight in (C - wmax, C + wmax]
+	class BalancedDP : public Algorithm
+	{
+		struct State
+		{
+			int64_t profit;
+			int64_t s; // items j < s can still be removed
+			int64_t done; // removals of the items j < done have been generated already
+			int trail; // last record in _trail, -1 for the break solution
+		};
+
+		std::vector<std::vector<State>> _buckets; // [w - _lowest_weight] = undominated states with weight w
+		int64_t _lowest_weight;
+		ToggleTrail _trail;
+		int _best_trail;
+		size_t _nb_states;
+
+		bool bound_test(int64_t weight, int64_t profit, int64_t s, size_t t) const;
+		void add_state(int64_t weight, int64_t profit, int64_t s, int parent, int item, size_t t);
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Strongly correlated instances (value == weight + k): the profit of a subset is its weight plus k times its
+	// cardinality, so a subset-sum dynamic programming that stores the best cardinality for every weight is exact.
+	// Only the items in a core around the break item are used in the dynamic programming, the core is doubled
+	// until the solution reaches the bound max_c min(C, sum of the c heaviest weights) + k c.
+	class StronglyCorrelated : public Algorithm
+	{
+		std::vector<int> _cardinality; // [w] = best number of core items with a total weight w, -1 if not reachable
+		std::vector<int> _last; // [w] = last record in _trail for _cardinality[w]
+		ToggleTrail _trail;
+
+		void solve_core(size_t first, size_t last, int64_t k);
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Subset-sum instances (value == weight): the reachable weights are stored as a bitset
+	class SubsetSum : public Algorithm
+	{
+		std::vector<uint64_t> _reachable; // bit c is set if a subset of the items has weight c
+
+		// bit c of 'bits' is set if a subset of the items [first, last) has weight c, for c = 0 .. capacity
+		void reachable(size_t first, size_t last, int64_t capacity, std::vector<uint64_t>& bits) const;
+		// items of [first, last) with a total weight of exactly 'target' in _best_solution, by divide and conquer over
+		// the items (Hirschberg) with bitsets of the reachable weights
+		void recover_subset(size_t first, size_t last, int64_t target, std::vector<uint64_t>& forward, std::vector<uint64_t>& backward);
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Subset-sum instances with a large capacity: divide and conquer over the distinct weights, where the sets of
+	// reachable weights of both halves are combined with a number-theoretic transform (Koiliaris and Xu)
+	class SubsetSumFFT : public Algorithm
+	{
+		struct Node
+		{
+			int left = -1; // -1 for a leaf
+			int right = -1;
+			std::vector<int> items; // leaf: all items with the same weight
+			int64_t size = 0; // highest weight in the set
+			std::vector<uint64_t> reachable; // bit c is set if weight c is reachable, c = 0 .. size
+		};
+		std::vector<Node> _nodes;
+		size_t _nb_transforms;
+
+		int build(const std::vector<std::vector<int>>& groups, size_t first, size_t last);
+		void sumset(Node& node);
+		void reconstruct(int node, int64_t c);
 
 	public:
 		void run(bool verbose) override;
@@ -129,14 +623,64 @@ namespace KP // knapsack
 
 	class DPItems : public Algorithm
 	{
+	public:
+		enum class Mode
+		{
+			table, // the states of all stages are stored
+			rolling, // only one row of states, the solution is recovered by divide and conquer (Hirschberg)
+		};
+
+	private:
+		Mode _mode = Mode::table;
+
+		void rolling();
+
 	public:
 		void run(bool verbose) override;
+		void set_mode(Mode mode) { _mode = mode; }
 	};
 
 	///////////////////////////////////////////////////////////////////////////
 
 	class DPCapacity : public Algorithm
 	{
+		void ring(size_t nb_stages, int64_t block, bool verbose); // the last nb_stages stages are kept
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Dynamic programming over the profits instead of the capacities: [p] = minimum weight of a subset with profit p
+	class DPProfits : public Algorithm
+	{
+		// [p] = minimum weight of the items [first, last) with a total profit of exactly p, for p = 0 .. max_profit
+		// (the maximum of int64_t if there is none that fits in the knapsack)
+		void min_weights(size_t first, size_t last, int64_t max_profit, std::vector<int64_t>& minweight) const;
+		// items of [first, last) with a total profit of exactly 'target' and the minimum weight in _best_solution,
+		// by divide and conquer over the items (Hirschberg)
+		void recover_by_profits(size_t first, size_t last, int64_t target, std::vector<int64_t>& forward, std::vector<int64_t>& backward);
+
+	public:
+		void run(bool verbose) override;
+	};
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Dynamic programming of Nemhauser and Ullmann: only the undominated (weight, profit) pairs are stored,
+	// so time and memory depend on the size of the Pareto frontier instead of the capacity,
+	// states that cannot improve the best solution with the remaining items are removed as well
+	class ParetoDP : public Algorithm
+	{
+		using State = TrailState; // trail == -1 for the empty solution
+
+		std::vector<State> _states; // sorted by weight, with strictly increasing profits
+		std::vector<State> _buffer;
+		ToggleTrail _trail;
+
+		void merge(size_t j);
+
 	public:
 		void run(bool verbose) override;
 	};
@@ -147,6 +691,11 @@ namespace KP // knapsack
 	{
 	public:
 		static std::unique_ptr<Algorithm> create(std::string& algorithm);
+
+		// Create the algorithm and read the data. The dynamic programming algorithms are replaced by a more
+		// specialized algorithm if the data has a special structure, and "DP" chooses between the capacities
+		// and the profits as states depending on which is smaller.
+		static std::unique_ptr<Algorithm> create(std::string& algorithm, const std::string& filename);
 	};
 
 
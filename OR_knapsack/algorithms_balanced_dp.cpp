@@ -0,0 +1,212 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+
+
+namespace KP
+{
+	bool BalancedDP::bound_test(int64_t weight, int64_t profit, int64_t s, size_t t) const
+	{
+		// Can this state still lead to a better solution? Item t is the next item that can be inserted,
+		// below capacity only the less efficient items j >= t can be added,
+		// above capacity the more efficient items j < s have to be removed
+		if (weight <= _capacity)
+			return t < _items.size()
+			&& (profit - _best_value - 1) * _items[t].weight + (_capacity - weight) * _items[t].value >= 0;
+		else
+			return s > 0
+			&& (profit - _best_value - 1) * _items[s - 1].weight + (_capacity - weight) * _items[s - 1].value >= 0;
+	}
+
+
+	void BalancedDP::add_state(int64_t weight, int64_t profit, int64_t s, int parent, int item, size_t t)
+	{
+		int trail = _trail.add(item, parent);
+		if (weight <= _capacity && profit > _best_value)
+		{
+			_best_value = profit;
+			_best_trail = trail;
+			_output << "\nNew best solution found with z = " << _best_value;
+		}
+
+		if (!bound_test(weight, profit, s, t))
+			return;
+
+		// dominance: a state with at least the same profit and at least as many removable items is better
+		auto& bucket = _buckets[weight - _lowest_weight];
+		for (auto&& state : bucket)
+			if (state.profit >= profit && state.s >= s)
+				return;
+
+		int64_t done = 0;
+		size_t nb_kept = 0;
+		for (auto&& state : bucket)
+		{
+			if (state.profit <= profit && state.s <= s)
+			{
+				if (state.profit == profit) // the removals already generated for this state are the same
+					done = state.done;
+				continue;
+			}
+			bucket[nb_kept++] = state;
+		}
+		_nb_states -= bucket.size() - nb_kept;
+		bucket.resize(nb_kept);
+
+		bucket.push_back({ profit, s, done, trail });
+		++_nb_states;
+	}
+
+
+	void BalancedDP::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nStarting the balanced dynamic programming algorithm of Pisinger ...";
+		_output.set_on(verbose);
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize: items heavier than the capacity never fit, and would widen the range of weights of the states
+		_items.erase(std::remove_if(_items.begin(), _items.end(), [this](const Item& item) { return item.weight > _capacity; }), _items.end());
+		_best_solution.assign(_items.size(), 0);
+		_trail.clear();
+		_best_trail = -1;
+		_nb_states = 0;
+		size_t max_states = 0;
+		const size_t n = _items.size();
+
+
+
+		// 1. sort items based on efficiency (highest to lowest)
+		_output << "\n\nSorting the items from most efficient to least efficient";
+		sort_by_efficiency();
+
+
+
+		// 2. find the break item
+		_output << "\n\nFinding the break item ...";
+		int64_t valuesum = 0, weightsum = 0;
+		size_t breakitem_index = find_break_item(valuesum, weightsum);
+		_best_value = valuesum;
+		int64_t upper_bound = valuesum;
+		if (breakitem_index < n)
+			upper_bound += (_capacity - weightsum) * _items[breakitem_index].value / _items[breakitem_index].weight;
+		_output << "\nBreakitem = " << breakitem_index + 1 << ", Pb = " << valuesum << ", Ws = " << weightsum
+			<< "\nUpper bound of Dantzig: U = " << upper_bound;
+
+
+
+		// 3. states for the weights (C - wmax, C + wmax], starting from the break solution
+		int64_t wmax = 1;
+		for (auto&& i : _items)
+			wmax = std::max<int64_t>(wmax, i.weight);
+		_lowest_weight = _capacity - wmax + 1;
+		_buckets.assign(2 * wmax, std::vector<State>());
+		if (breakitem_index < n)
+		{
+			_buckets[weightsum - _lowest_weight].push_back({ valuesum, static_cast<int64_t>(breakitem_index), 0, -1 });
+			_nb_states = 1;
+		}
+		_output << "\nStates for the weights " << _lowest_weight << " to " << _capacity + wmax;
+
+
+
+		// 4. balanced insertions of the items t >= b, each followed by the balanced removals
+		size_t t = breakitem_index;
+		for (; t < n && _nb_states > 0 && _best_value < upper_bound; ++t)
+		{
+			// remove the states that can no longer improve z
+			for (int64_t weight = _lowest_weight; weight <= _capacity + wmax; ++weight)
+			{
+				auto& bucket = _buckets[weight - _lowest_weight];
+				size_t nb_kept = 0;
+				for (auto&& state : bucket)
+					if (bound_test(weight, state.profit, state.s, t))
+						bucket[nb_kept++] = state;
+				_nb_states -= bucket.size() - nb_kept;
+				bucket.resize(nb_kept);
+			}
+
+			// insert item t in the states below capacity, from the heaviest so that no state receives item t twice
+			for (int64_t weight = _capacity; weight >= _lowest_weight; --weight)
+			{
+				auto& bucket = _buckets[weight - _lowest_weight];
+				size_t count = bucket.size();
+				for (size_t k = 0; k < count; ++k)
+				{
+					State state = bucket[k];
+					add_state(weight + _items[t].weight, state.profit + _items[t].value, state.s, state.trail, static_cast<int>(t), t + 1);
+				}
+			}
+
+			// remove items j < s from the states above capacity, from the heaviest so that removals can be repeated
+			for (int64_t weight = _capacity + wmax; weight > _capacity; --weight)
+			{
+				auto& bucket = _buckets[weight - _lowest_weight];
+				for (size_t k = 0; k < bucket.size(); ++k)
+				{
+					for (int64_t j = bucket[k].s - 1; j >= bucket[k].done; --j)
+						add_state(weight - _items[j].weight, bucket[k].profit - _items[j].value, j, bucket[k].trail, static_cast<int>(j), t + 1);
+					bucket[k].done = bucket[k].s;
+				}
+			}
+
+			max_states = std::max(max_states, _nb_states);
+			_output << "\nItem " << t + 1 << ": states = " << _nb_states << ", z = " << _best_value;
+
+			if (_trail.needs_compaction())
+				_trail.compact(_buckets, _best_trail);
+		}
+		_buckets.clear();
+
+
+
+		// 5. store optimal solution
+		for (size_t i = 0; i < breakitem_index; ++i)
+			_best_solution[i] = 1;
+		_trail.apply(_best_trail, _best_solution);
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nItems inserted: " << t - std::min(t, breakitem_index)
+			<< "\nMaximum number of states: " << max_states
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in BalancedDP: Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in BalancedDP: Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+}
\ No newline at end of file
@@ -206,6 +206,312 @@ namespace KP
 	}
 
 
+	bool Algorithm::is_subset_sum() const
+	{
+		for (auto&& i : _items)
+			if (i.value != i.weight)
+				return false;
+		return true;
+	}
+
+
+	bool Algorithm::is_strongly_correlated() const
+	{
+		for (auto&& i : _items)
+			if (i.value - i.weight != _items.front().value - _items.front().weight)
+				return false;
+		return true;
+	}
+
+
+	int64_t Algorithm::dantzig_bound() const
+	{
+		std::vector<Item> items = _items;
+		std::sort(items.begin(), items.end(), [](const Item& a, const Item& b)
+			{
+				return static_cast<int64_t>(a.value) * b.weight > static_cast<int64_t>(a.weight) * b.value;
+			}
+		);
+
+		int64_t valuesum = 0, weightsum = 0;
+		for (auto&& i : items)
+		{
+			if (weightsum + i.weight > _capacity)
+				return valuesum + (_capacity - weightsum) * i.value / i.weight;
+
+			valuesum += i.value;
+			weightsum += i.weight;
+		}
+		return valuesum;
+	}
+
+
+	void Algorithm::sort_by_efficiency(size_t first, size_t last)
+	{
+		std::sort(_items.begin() + first, _items.begin() + last, [](const Item& a, const Item& b)
+			{
+				return static_cast<int64_t>(a.value) * b.weight > static_cast<int64_t>(a.weight) * b.value;
+			}
+		);
+	}
+
+
+	size_t Algorithm::find_break_item(int64_t& valuesum, int64_t& weightsum) const
+	{
+		valuesum = 0;
+		weightsum = 0;
+		for (size_t i = 0; i < _items.size(); ++i)
+		{
+			if (weightsum + _items[i].weight > _capacity)
+				return i;
+
+			valuesum += _items[i].value;
+			weightsum += _items[i].weight;
+		}
+		return _items.size();
+	}
+
+
+	void Algorithm::best_profits(size_t first, size_t last, int64_t capacity, std::vector<int64_t>& profits) const
+	{
+		// f(c) = best profit of the items [first, last) with capacity c, one row that is updated for every item
+		// two items per pass over the row
+		profits.assign(capacity + 1, 0);
+		size_t j = first;
+		for (; j + 1 < last; j += 2)
+			RowKernels::add_items(profits.data(), capacity, _items[j], _items[j + 1]);
+		if (j < last)
+			RowKernels::add_item(profits.data(), capacity, _items[j], nullptr);
+	}
+
+
+	void Algorithm::recover_solution(size_t first, size_t last, int64_t capacity)
+	{
+		std::vector<int64_t> forward, backward;
+		if (first < last)
+			divide_and_conquer(first, last, capacity, forward, backward);
+	}
+
+
+	void Algorithm::divide_and_conquer(size_t first, size_t last, int64_t capacity, std::vector<int64_t>& forward, std::vector<int64_t>& backward)
+	{
+		// Hirschberg: the best profits of both halves of the items show how the capacity is divided in an optimal
+		// solution, both halves are then solved with their part of the capacity. Every level of the recursion
+		// takes O(n C) time in total and the rows are reused, so O(n C) time and O(C) memory.
+		if (capacity == 0)
+			return;
+		if (last - first == 1)
+		{
+			_best_solution[first] = _items[first].weight <= capacity ? 1 : 0;
+			return;
+		}
+
+		size_t mid = first + (last - first) / 2;
+		best_profits(first, mid, capacity, forward);
+		best_profits(mid, last, capacity, backward);
+
+		int64_t best_c = 0;
+		for (int64_t c = 0; c <= capacity; ++c)
+			if (forward[c] + backward[capacity - c] > forward[best_c] + backward[capacity - best_c])
+				best_c = c;
+
+		_output << "\nItems " << first + 1 << " to " << last << " with capacity " << capacity << ": capacity "
+			<< best_c << " for items " << first + 1 << " to " << mid << " (profit " << forward[best_c] << "), "
+			<< capacity - best_c << " for items " << mid + 1 << " to " << last << " (profit " << backward[capacity - best_c] << ")";
+
+		divide_and_conquer(first, mid, best_c, forward, backward);
+		divide_and_conquer(mid, last, capacity - best_c, forward, backward);
+	}
+
+
+	///////////////////////////////////////////////////////////////////////////
+
+
+	int ToggleTrail::add(int item, int parent)
+	{
+		_records.push_back({ item, parent });
+		return static_cast<int>(_records.size()) - 1;
+	}
+
+
+	void ToggleTrail::apply(int rec, std::vector<int>& solution) const
+	{
+		while (rec >= 0)
+		{
+			solution[_records[rec].item] = 1 - solution[_records[rec].item];
+			rec = _records[rec].parent;
+		}
+	}
+
+
+	void ToggleTrail::compact(std::vector<int>& roots)
+	{
+		// mark: -2 = unreachable, -1 = reachable
+		std::vector<int> index(_records.size(), -2);
+		for (auto&& root : roots)
+		{
+			int rec = root;
+			while (rec >= 0 && index[rec] == -2)
+			{
+				index[rec] = -1;
+				rec = _records[rec].parent;
+			}
+		}
+
+		// sweep: parents always have a lower index than their children
+		size_t nb_kept = 0;
+		for (size_t i = 0; i < _records.size(); ++i)
+		{
+			if (index[i] == -2)
+				continue;
+
+			int parent = _records[i].parent;
+			_records[nb_kept] = { _records[i].item, parent >= 0 ? index[parent] : -1 };
+			index[i] = static_cast<int>(nb_kept);
+			++nb_kept;
+		}
+		_records.resize(nb_kept);
+		_compacted_size = nb_kept;
+
+		for (auto&& root : roots)
+			if (root >= 0)
+				root = index[root];
+	}
+
+
+	void merge_states(const std::vector<TrailState>& states, int j, int64_t dp, int64_t dw, int64_t max_weight,
+		ToggleTrail& trail, std::vector<TrailState>& merged)
+	{
+		merged.clear();
+		merged.reserve(2 * states.size());
+
+		size_t a = 0, b = 0;
+		int64_t last_profit = std::numeric_limits<int64_t>::min();
+		while (a < states.size() || b < states.size())
+		{
+			bool toggled;
+			if (b == states.size() || states[b].weight + dw > max_weight)
+			{
+				if (a == states.size())
+					break;
+				toggled = false;
+			}
+			else if (a == states.size())
+				toggled = true;
+			else if (states[b].weight + dw != states[a].weight)
+				toggled = states[b].weight + dw < states[a].weight;
+			else
+				toggled = states[b].profit + dp > states[a].profit;
+
+			if (toggled)
+			{
+				if (states[b].profit + dp > last_profit)
+				{
+					last_profit = states[b].profit + dp;
+					merged.push_back({ last_profit, states[b].weight + dw, trail.add(j, states[b].trail) });
+				}
+				++b;
+			}
+			else
+			{
+				if (states[a].profit > last_profit)
+				{
+					last_profit = states[a].profit;
+					merged.push_back(states[a]);
+				}
+				++a;
+			}
+		}
+	}
+
+
+	///////////////////////////////////////////////////////////////////////////
+
+
+	void LPBound::build(const std::vector<Item>& items)
+	{
+		const size_t n = items.size();
+		_value.assign(n + 1, 0);
+		_weight.assign(n + 1, 0);
+		for (size_t j = 0; j < n; ++j)
+		{
+			_value[j + 1] = _value[j] + items[j].value;
+			_weight[j + 1] = _weight[j] + items[j].weight;
+		}
+
+		// node i of a Fenwick tree holds the sum of the items [i - lowbit(i), i)
+		_tree_value.assign(n + 1, 0);
+		_tree_weight.assign(n + 1, 0);
+		for (size_t i = 1; i <= n; ++i)
+		{
+			_tree_value[i] = _value[i] - _value[i - (i & (0 - i))];
+			_tree_weight[i] = _weight[i] - _weight[i - (i & (0 - i))];
+		}
+	}
+
+
+	void LPBound::update(size_t j, int64_t value, int64_t weight)
+	{
+		for (size_t i = j + 1; i < _tree_weight.size(); i += i & (0 - i))
+		{
+			_tree_value[i] += value;
+			_tree_weight[i] += weight;
+		}
+	}
+
+
+	int64_t LPBound::add_bound(size_t first, int64_t capacity) const
+	{
+		// last item r such that the items [first, r) fit
+		size_t r = std::upper_bound(_weight.begin() + first, _weight.end(), _weight[first] + capacity) - _weight.begin() - 1;
+		int64_t bound = _value[r] - _value[first];
+		if (r + 1 < _weight.size())
+			bound += (capacity - (_weight[r] - _weight[first])) * (_value[r + 1] - _value[r]) / (_weight[r + 1] - _weight[r]);
+		return bound;
+	}
+
+
+	int64_t LPBound::remove_bound(size_t last, int64_t excess) const
+	{
+		if (excess <= 0)
+			return 0;
+		if (_weight[last] < excess)
+			return -1;
+
+		// first item q such that removing the items [q, last) frees enough weight
+		size_t q = std::upper_bound(_weight.begin(), _weight.begin() + last + 1, _weight[last] - excess) - _weight.begin() - 1;
+		int64_t lost = _value[last] - _value[q + 1];
+		int64_t missing = excess - (_weight[last] - _weight[q + 1]); // part of item q that has to be removed
+		int64_t value = _value[q + 1] - _value[q], weight = _weight[q + 1] - _weight[q];
+		return lost + (missing * value + weight - 1) / weight;
+	}
+
+
+	size_t LPBound::break_item(int64_t capacity, int64_t& value, int64_t& weight) const
+	{
+		// descend the Fenwick tree to the longest prefix of which the items that are not skipped fit,
+		// the next item is then an item that is not skipped and doesn't fit
+		const size_t n = _tree_weight.size() - 1;
+		size_t step = 1;
+		while (2 * step <= n)
+			step *= 2;
+
+		size_t position = 0;
+		value = 0;
+		weight = 0;
+		for (; step > 0; step /= 2)
+		{
+			if (position + step <= n && weight + _tree_weight[position + step] <= capacity)
+			{
+				position += step;
+				value += _tree_value[position];
+				weight += _tree_weight[position];
+			}
+		}
+		return position;
+	}
+
+
 	///////////////////////////////////////////////////////////////////////////
 
 
@@ -217,17 +523,120 @@ namespace KP
 
 		if (algorithm == "ce")
 			return std::make_unique<CompleteEnumeration>();
+		else if (algorithm == "mitm")
+		{
+			auto enumeration = std::make_unique<CompleteEnumeration>();
+			enumeration->set_mode(CompleteEnumeration::Mode::meet_in_the_middle);
+			return enumeration;
+		}
+		else if (algorithm == "sch")
+		{
+			auto enumeration = std::make_unique<CompleteEnumeration>();
+			enumeration->set_mode(CompleteEnumeration::Mode::schroeppel_shamir);
+			return enumeration;
+		}
+		else if (algorithm == "gc")
+		{
+			auto enumeration = std::make_unique<CompleteEnumeration>();
+			enumeration->set_mode(CompleteEnumeration::Mode::gray_code);
+			return enumeration;
+		}
 		else if (algorithm == "bb")
 			return std::make_unique<BranchAndBound>();
+		else if (algorithm == "bf")
+		{
+			auto bb = std::make_unique<BranchAndBound>();
+			bb->set_mode(BranchAndBound::Mode::best_first);
+			return bb;
+		}
+		else if (algorithm == "hs")
+			return std::make_unique<HorowitzSahni>();
 		else if (algorithm == "pi")
 			return std::make_unique<PisingerBB>();
+		else if (algorithm == "ex")
+		{
+			auto pisinger = std::make_unique<PisingerBB>();
+			pisinger->set_expanding_core(true);
+			return pisinger;
+		}
+		else if (algorithm == "mt2")
+			return std::make_unique<MT2>();
+		else if (algorithm == "mk")
+			return std::make_unique<Minknap>();
+		else if (algorithm == "co")
+			return std::make_unique<Combo>();
 		else if (algorithm == "dp1")
 			return std::make_unique<DPItems>();
 		else if (algorithm == "dp2")
 			return std::make_unique<DPCapacity>();
+		else if (algorithm == "dp3")
+			return std::make_unique<DPProfits>();
+		else if (algorithm == "dp1r")
+		{
+			auto dp = std::make_unique<DPItems>();
+			dp->set_mode(DPItems::Mode::rolling);
+			return dp;
+		}
+		else if (algorithm == "dp")
+		{
+			auto dp = std::make_unique<DPItems>();
+			dp->set_mode(DPItems::Mode::rolling);
+			return dp;
+		}
+		else if (algorithm == "bal")
+			return std::make_unique<BalancedDP>();
+		else if (algorithm == "nu")
+			return std::make_unique<ParetoDP>();
+		else if (algorithm == "sc")
+			return std::make_unique<StronglyCorrelated>();
+		else if (algorithm == "ss")
+			return std::make_unique<SubsetSum>();
+		else if (algorithm == "ssfft")
+			return std::make_unique<SubsetSumFFT>();
 		else if (algorithm == "ip")
 			return std::make_unique<ORToolsIP>();
 		else
 			throw std::invalid_argument("No algorithm " + algorithm + " exists");
 	}
+
+
+	std::unique_ptr<Algorithm> AlgorithmFactory::create(std::string& algorithm, const std::string& filename)
+	{
+		std::unique_ptr<Algorithm> alg = create(algorithm);
+		alg->read_data(filename);
+
+		auto replace = [&alg](std::unique_ptr<Algorithm> other)
+			{
+				other->_items = std::move(alg->_items);
+				other->_capacity = alg->_capacity;
+				return other;
+			};
+
+		if ((algorithm == "dp" || algorithm == "dp1" || algorithm == "dp1r" || algorithm == "dp2") && alg->is_subset_sum())
+		{
+			std::cout << "\nSubset-sum instance: using the bit-parallel subset-sum algorithm instead of " << algorithm;
+			return replace(std::make_unique<SubsetSum>());
+		}
+
+		if (algorithm == "dp" && alg->is_strongly_correlated())
+		{
+			std::cout << "\nStrongly correlated instance: using the dynamic programming over weights and cardinalities";
+			return replace(std::make_unique<StronglyCorrelated>());
+		}
+
+		if (algorithm == "dp")
+		{
+			int64_t max_profit = alg->dantzig_bound();
+			if (max_profit < alg->_capacity)
+			{
+				std::cout << "\nThe optimal profit is at most " << max_profit << " < capacity " << alg->_capacity
+					<< ": using dynamic programming over the profits";
+				return replace(std::make_unique<DPProfits>());
+			}
+			std::cout << "\nThe optimal profit can be up to " << max_profit << " >= capacity " << alg->_capacity
+				<< ": using dynamic programming over the capacities";
+		}
+
+		return alg;
+	}
 }
\ No newline at end of file
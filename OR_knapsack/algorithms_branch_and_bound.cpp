@@ -1,204 +1,454 @@
 #include "algorithms.h"
 #include <chrono>
 #include <stdexcept>
+#include <thread>
 
 
 
 namespace KP
 {
-	void BranchAndBound::run(bool verbose)
+	void BranchAndBound::fix(Search& search, size_t item, bool x)
 	{
-		_output.set_on(true);
-		_output << "\n\n\nStarting the branch-and-bound method of Winston ...";
-		_output.set_on(verbose);
+		search.trail.push_back({ item, search.lp });
+		search.items_fixed[item] = x ? 1 : 0;
+		search.lp_bound.skip(item, _items[item]);
+		if (x)
+		{
+			search.lp.fixed_value += _items[item].value;
+			search.lp.fixed_weight += _items[item].weight;
+		}
+	}
 
-		auto start_time = std::chrono::system_clock::now();
-		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
 
-		// Initialize
-		size_t _nodes_explored = 0;
-		std::vector<int> _items_x; // current solution
-		std::vector<bool> _items_fixed; // current branching restrictions
+	void BranchAndBound::undo(Search& search, size_t trail_size)
+	{
+		while (search.trail.size() > trail_size)
+		{
+			search.items_fixed[search.trail.back().item] = -1;
+			search.lp_bound.restore(search.trail.back().item, _items[search.trail.back().item]);
+			search.lp = search.trail.back().lp;
+			search.trail.pop_back();
+		}
+	}
 
-		_best_solution.reserve(_items.size());
-		for (size_t i = 0; i < _items.size(); ++i)
+
+	int BranchAndBound::add_path(size_t item, bool x, int parent)
+	{
+		if (parent >= 0)
+			++_path[parent].references;
+
+		if (_free_path.empty())
 		{
-			_items_x.push_back(0);
-			_items_fixed.push_back(false); // all items free
-			_best_solution.push_back(0); // all x = 0
+			_path.push_back({ item, x, parent, 1 });
+			return static_cast<int>(_path.size()) - 1;
 		}
-		_best_value = 0;
-		_nodes_explored = 0;
 
+		int rec = _free_path.back();
+		_free_path.pop_back();
+		_path[rec] = { item, x, parent, 1 };
+		return rec;
+	}
 
 
-		// 1. sort items based on efficiency (highest to lowest)
-		_output << "\n\nSorting the items from most efficient to least efficient";
-		std::sort(_items.begin(), _items.end(), [](const Item& a, const Item& b)
+	void BranchAndBound::release_path(int rec)
+	{
+		// a record without references is recycled, which releases its parent
+		while (rec >= 0 && --_path[rec].references == 0)
+		{
+			_free_path.push_back(rec);
+			rec = _path[rec].parent;
+		}
+	}
+
+
+	bool BranchAndBound::evaluate(Search& search, int64_t& upperbound)
+	{
+		search.nodes_explored.store(search.nodes_explored.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		LP& lp = search.lp;
+
+		// calculate solution LP relaxation
+		bool feasible = lp.fixed_weight <= _capacity;
+		if (feasible)
+			lp.breakitem = search.lp_bound.break_item(_capacity - lp.fixed_weight, lp.free_value, lp.free_weight);
+
+		int64_t residual = _capacity - lp.fixed_weight - lp.free_weight;
+		bool integer = lp.breakitem == _items.size() || residual == 0;
+		upperbound = lp.fixed_value + lp.free_value;
+		double z_LP = static_cast<double>(upperbound);
+		if (feasible && !integer)
+		{
+			upperbound += residual * _items[lp.breakitem].value / _items[lp.breakitem].weight;
+			z_LP += static_cast<double>(residual) * _items[lp.breakitem].value / _items[lp.breakitem].weight;
+		}
+
+
+		// branch further or backtrack
+		if (!feasible)
+		{
+			_output << "\nInfeasible. Backtrack ...";
+		}
+		else if (integer)
+		{
+			_output << "\nInteger solution with z = " << upperbound;
+
+			if (upperbound > _incumbent.load(std::memory_order_relaxed))
 			{
-				if (a.value * b.weight > a.weight * b.value)
-					return true;
-				return false;
+				std::lock_guard<std::mutex> lock(_solution_mutex);
+				if (upperbound > _incumbent.load(std::memory_order_relaxed))
+				{
+					_incumbent.store(upperbound, std::memory_order_relaxed);
+					for (size_t i = 0; i < _items.size(); ++i)
+						_best_solution[i] = search.items_fixed[i] == -1 ? (i < lp.breakitem ? 1 : 0) : search.items_fixed[i];
+
+					_output << "\nNew best solution found! Update LB = " << upperbound;
+				}
 			}
-		);
 
+			_output << "\nBacktrack ...";
+		}
+		else if (upperbound <= _incumbent.load(std::memory_order_relaxed)) // fathom due to upper bound test
+		{
+			_output << "\nupperbound = " << upperbound << " <= LB = " << _incumbent.load(std::memory_order_relaxed) << ". Backtrack ...";
+		}
+		else // branch further
+		{
+			_output << "\nz = " << z_LP;
+			return true;
+		}
+		return false;
+	}
 
 
-		// 2. find the break item and store x vector
-		size_t breakitem_index = 0;
-		size_t weightsum = 0, valuesum = 0;
-		for (size_t i = 0; i < _items.size(); ++i)
+	void BranchAndBound::depth_first(Search& search, size_t item)
+	{
+		// The stack is reused by every depth-first search, so that the search loop doesn't allocate memory
+		const size_t root_trail_size = search.trail.size();
+		std::vector<Node>& stack = search.stack;
+		stack.clear();
+		stack.push_back({ item, true, root_trail_size });
+		stack.push_back({ item, false, root_trail_size });
+
+		while (!stack.empty())
 		{
-			weightsum += _items[i].weight;
-			if (weightsum > _capacity)
+			Node current = stack.back();
+			stack.pop_back();
+
+			undo(search, current.trail_size);
+			fix(search, current.item, current.x);
+			_output << "\n\nNew node: x[" << current.item + 1 << "] = " << static_cast<int>(current.x);
+
+			int64_t upperbound;
+			if (evaluate(search, upperbound))
 			{
-				breakitem_index = i;
-				weightsum -= _items[i].weight;
-				break;
+				// Create new nodes that fix the break item
+				stack.push_back({ search.lp.breakitem, true, search.trail.size() });
+				stack.push_back({ search.lp.breakitem, false, search.trail.size() });
 			}
-			valuesum += _items[i].value;
-			_best_solution[i] = 1;
-		}
-		_best_value = valuesum;
 
+			if (search.nodes_explored.load(std::memory_order_relaxed) % 4096 == 0)
+				report(false);
+		}
 
+		undo(search, root_trail_size);
+	}
 
 
-		// 3. branching
-		struct Node
+	void BranchAndBound::best_first(size_t item, int64_t upperbound)
+	{
+		// The open nodes are kept in a binary heap on their upper bound. A node only stores the last record of its
+		// fixed path, the state of a node is rebuilt from the root when it is selected.
+		struct OpenNode
 		{
-			std::vector<std::pair<size_t, bool>> fixed_path; // Sequence of (variable, value) fixed to reach this node
+			int64_t upperbound;
+			size_t item; // item to branch on
+			int path; // last (variable, value) fixed to reach this node, -1 for the root
 		};
-		std::vector<Node> nodes;
-		nodes.push_back({ { { breakitem_index, false } } });
-		nodes.push_back({ { { breakitem_index, true } } });
+		auto less = [](const OpenNode& a, const OpenNode& b) { return a.upperbound < b.upperbound; };
+		auto memory = [this](const std::vector<OpenNode>& nodes) { return nodes.size() * sizeof(OpenNode) + (_path.size() - _free_path.size()) * sizeof(PathRecord); };
+
+		Search& search = *_searches[0];
+		_path.clear();
+		_free_path.clear();
+		std::vector<OpenNode> nodes;
+		std::vector<int> replay;
+		nodes.push_back({ upperbound, item, -1 });
+		size_t max_memory = memory(nodes);
+		bool limit_reached = false;
 
 		while (!nodes.empty())
 		{
-			Node current = nodes.back();
+			std::pop_heap(nodes.begin(), nodes.end(), less);
+			OpenNode current = nodes.back();
 			nodes.pop_back();
-			++_nodes_explored;
 
-			// reset state
-			for (size_t i = 0; i < _items.size(); ++i)
+			// the node with the highest upper bound bounds all open nodes
+			_global_bound = current.upperbound;
+			if (current.upperbound <= _incumbent)
 			{
-				_items_fixed[i] = false;
-				_items_x[i] = 0;
+				_output << "\n\nUpper bound of all open nodes <= LB = " << _incumbent.load();
+				break;
 			}
 
-			// apply the fixed path
-			for (const auto& it : current.fixed_path)
+			undo(search, 0);
+			replay.clear();
+			for (int rec = current.path; rec >= 0; rec = _path[rec].parent)
+				replay.push_back(rec);
+			for (auto it = replay.rbegin(); it != replay.rend(); ++it)
+				fix(search, _path[*it].item, _path[*it].x);
+
+			// two children need at most two nodes and two records
+			if (memory(nodes) + 2 * (sizeof(OpenNode) + sizeof(PathRecord)) > _memory_limit)
+			{
+				if (!limit_reached)
+				{
+					_output << "\n\nMemory limit for the open nodes reached: continuing depth-first below the best nodes";
+					limit_reached = true;
+				}
+				depth_first(search, current.item);
+			}
+			else
 			{
-				_items_fixed[it.first] = true;
-				_items_x[it.first] = it.second ? 1 : 0;
+				for (bool x : { true, false })
+				{
+					size_t trail_size = search.trail.size();
+					fix(search, current.item, x);
+					_output << "\n\nNew node: x[" << current.item + 1 << "] = " << static_cast<int>(x);
+
+					int64_t child_upperbound;
+					if (evaluate(search, child_upperbound))
+					{
+						nodes.push_back({ child_upperbound, search.lp.breakitem, add_path(current.item, x, current.path) });
+						std::push_heap(nodes.begin(), nodes.end(), less);
+					}
+					undo(search, trail_size);
+				}
+				max_memory = std::max(max_memory, memory(nodes));
 			}
+			release_path(current.path);
 
-			size_t branching_variable = current.fixed_path.back().first;
-			bool x = current.fixed_path.back().second;
-			_output << "\n\nNew node: x[" << branching_variable + 1 << "] = " << static_cast<int>(x);
+			report(false);
+		}
 
+		undo(search, 0);
+		_output << "\n\nMaximum memory of the open nodes (bytes): " << max_memory;
+	}
 
-			// 2. calculate solution LP relaxation
-			size_t new_branching_var = 0;
-			bool integer = true;
-			bool feasible = true;
-			double z_LP = 0;
-			size_t upperbound = 0;
-			{
-				size_t Ps = 0, Ws = 0;
-				double fraction = 0;
 
-				for (size_t i = 0; i < _items.size(); ++i) // first fixed variables
+	void BranchAndBound::parallel_depth_first(size_t item)
+	{
+		// The first thread starts with the two children of the root, the other threads steal their first nodes.
+		// The threads don't write to the output, only the first one reports the gap.
+		Search& search = *_searches[0];
+		search.stack.clear();
+		search.bottom = 0;
+		search.stack.push_back({ item, true, 0 });
+		search.stack.push_back({ item, false, 0 });
+		_busy = 1;
+
+		bool on = _output.is_on();
+		_output.set_on(false);
+
+		std::vector<std::thread> threads;
+		for (size_t t = 1; t < _searches.size(); ++t)
+			threads.emplace_back(&BranchAndBound::work, this, t);
+		work(0);
+		for (auto&& thread : threads)
+			thread.join();
+
+		_output.set_on(on);
+	}
+
+
+	void BranchAndBound::work(size_t thread)
+	{
+		// Depth-first search on the stack of this thread. The stack and the trail are only changed while holding
+		// the lock of the search, so that another thread can copy the fixed path of the first node.
+		Search& search = *_searches[thread];
+		bool busy = thread == 0;
+		bool branch = false;
+
+		while (true)
+		{
+			if (!busy)
+			{
+				// idle: steal a node until no thread has open nodes left
+				while (!steal(thread))
 				{
-					if (_items_fixed[i] && _items_x[i] == 1)
-					{
-						Ps += _items[i].value;
-						Ws += _items[i].weight;
-					}
-					else if (!_items_fixed[i])
-						_items_x[i] = 0;
+					if (_busy == 0)
+						return;
+					std::this_thread::yield();
 				}
-				if (Ws > _capacity)
+				busy = true;
+			}
+
+			Node current;
+			{
+				std::lock_guard<std::mutex> lock(search.mutex);
+				if (branch)
 				{
-					feasible = false;
+					// Create new nodes that fix the break item
+					search.stack.push_back({ search.lp.breakitem, true, search.trail.size() });
+					search.stack.push_back({ search.lp.breakitem, false, search.trail.size() });
 				}
-				else if (Ws == _capacity)
+
+				if (search.stack.size() == search.bottom)
 				{
-					upperbound = Ps;
+					search.stack.clear();
+					search.bottom = 0;
+					busy = false;
 				}
 				else
 				{
-					for (size_t i = 0; i < _items.size(); ++i) // then free variables
-					{
-						if (!_items_fixed[i])
-						{
-							if (Ws + _items[i].weight <= _capacity)
-							{
-								Ps += _items[i].value;
-								Ws += _items[i].weight;
-								upperbound = Ps;
-								z_LP = Ps;
-
-								_items_x[i] = 1;
-
-								if (Ws == _capacity)
-									break;
-							}
-							else
-							{
-								integer = false;
-								fraction = (static_cast<double>(_capacity) - static_cast<double>(Ws)) / static_cast<double>(_items[i].weight);
-								z_LP = Ps + fraction * _items[i].value;
-								upperbound = static_cast<size_t>(z_LP + 0.02);
-								new_branching_var = i;
-
-								break;
-							}
-						}
-					}
+					current = search.stack.back();
+					search.stack.pop_back();
+					undo(search, current.trail_size);
+					fix(search, current.item, current.x);
 				}
 			}
 
-
-			// 3. branch further or backtrack
-			if (!feasible)
+			if (!busy)
 			{
-				_output << "\nInfeasible. Backtrack ...";
+				--_busy;
+				branch = false;
+				continue;
 			}
-			else if (integer)
-			{
-				_output << "\nInteger solution with z = " << upperbound;
 
-				if (upperbound > _best_value)
-				{
+			int64_t upperbound;
+			branch = evaluate(search, upperbound);
 
-					_best_value = upperbound;
-					for (size_t i = 0; i < _items.size(); ++i)
-						_best_solution[i] = _items_x[i];
+			if (thread == 0 && search.nodes_explored.load(std::memory_order_relaxed) % 4096 == 0)
+				report(false);
+		}
+	}
 
-					_output << "\nNew best solution found! Update LB = " << upperbound;
-				}
 
-				_output << "\nBacktrack ...";
-			}
-			else if (upperbound <= _best_value) // fathom due to upper bound test
+	bool BranchAndBound::steal(size_t thread)
+	{
+		// Take the first node of another thread, which is the root of the largest subtree, and copy its fixed path
+		Search& thief = *_searches[thread];
+		for (size_t k = 1; k < _searches.size(); ++k)
+		{
+			Search& victim = *_searches[(thread + k) % _searches.size()];
+			Node node;
 			{
-				_output << "\nupperbound = " << upperbound << " <= LB = " << _best_value << ". Backtrack ...";
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (victim.stack.size() == victim.bottom)
+					continue;
+
+				// the victim has open nodes, so it is busy and _busy can't become 0 before this thread is busy
+				++_busy;
+				node = victim.stack[victim.bottom++];
+				thief.stolen_path.clear();
+				for (size_t r = 0; r < node.trail_size; ++r)
+				{
+					size_t item = victim.trail[r].item;
+					thief.stolen_path.push_back({ item, victim.items_fixed[item] == 1 });
+				}
 			}
-			else // branch further
-			{
-				_output << "\nz = " << z_LP;
 
-				// Create new nodes by extending the fixed path
-				std::vector<std::pair<size_t, bool>> path_true = current.fixed_path;
-				path_true.push_back({ new_branching_var, true });
-				nodes.push_back({ path_true });
+			std::lock_guard<std::mutex> lock(thief.mutex);
+			undo(thief, 0);
+			for (auto&& fixed : thief.stolen_path)
+				fix(thief, fixed.first, fixed.second);
+			thief.stack.push_back(node);
+			return true;
+		}
+		return false;
+	}
 
-				std::vector<std::pair<size_t, bool>> path_false = current.fixed_path;
-				path_false.push_back({ new_branching_var, false });
-				nodes.push_back({ path_false });
-			}
+
+	size_t BranchAndBound::nodes_explored() const
+	{
+		size_t nodes = 0;
+		for (auto&& search : _searches)
+			nodes += search->nodes_explored.load(std::memory_order_relaxed);
+		return nodes;
+	}
+
+
+	void BranchAndBound::report(bool always)
+	{
+		// the gap between the best solution and the upper bound of all open nodes, at most once per second
+		auto now = std::chrono::system_clock::now();
+		if (!always && now - _last_report < std::chrono::seconds(1))
+			return;
+		_last_report = now;
+
+		int64_t z = _incumbent.load(std::memory_order_relaxed);
+		_progress << "\nNodes = " << nodes_explored() << ", z = " << z << ", U = " << _global_bound
+			<< ", gap = " << (_global_bound > 0 ? 100.0 * (_global_bound - z) / _global_bound : 0.0) << "%";
+	}
+
+
+	void BranchAndBound::run(bool verbose)
+	{
+		_output.set_on(true);
+		if (_mode == Mode::best_first)
+			_output << "\n\n\nStarting the best-first branch-and-bound method ...";
+		else
+			_output << "\n\n\nStarting the branch-and-bound method of Winston ...";
+
+		const size_t nb_threads = _mode == Mode::best_first ? 1
+			: _threads > 0 ? _threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+		if (nb_threads > 1)
+			_output << "\nUsing " << nb_threads << " threads, without explaining the steps of the search";
+		_output.set_on(verbose);
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+		// Initialize
+		const size_t n = _items.size();
+		_searches.clear();
+		for (size_t t = 0; t < nb_threads; ++t)
+		{
+			_searches.push_back(std::make_unique<Search>());
+			_searches.back()->items_fixed.assign(n, -1); // all items free
+		}
+		_last_report = start_time;
+
+		_best_solution.assign(n, 0); // all x = 0
+		_best_value = 0;
+
+
+
+		// 1. sort items based on efficiency (highest to lowest)
+		_output << "\n\nSorting the items from most efficient to least efficient";
+		sort_by_efficiency();
+		_searches[0]->lp_bound.build(_items);
+
+
+
+		// 2. find the break item and store x vector
+		int64_t valuesum = 0, weightsum = 0;
+		size_t breakitem_index = find_break_item(valuesum, weightsum);
+		for (size_t i = 0; i < breakitem_index; ++i)
+			_best_solution[i] = 1;
+		_incumbent = valuesum;
+		_global_bound = dantzig_bound();
+		for (auto&& search : _searches)
+		{
+			search->lp_bound = _searches[0]->lp_bound;
+			search->lp = { breakitem_index, 0, 0, valuesum, weightsum };
+		}
+		if (breakitem_index == n)
+			breakitem_index = 0;
+
+
+
+		// 3. branching
+		if (n > 0)
+		{
+			if (_mode == Mode::best_first)
+				best_first(breakitem_index, _global_bound);
+			else if (nb_threads > 1)
+				parallel_depth_first(breakitem_index);
+			else
+				depth_first(*_searches[0], breakitem_index);
 		}
+		_best_value = _incumbent;
+		_global_bound = _best_value;
+		report(true);
 
 
 
@@ -206,7 +456,7 @@ namespace KP
 		elapsed_time = std::chrono::system_clock::now() - start_time;
 		_output.set_on(true);
 		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
-			<< "\nNodes explored: " << _nodes_explored
+			<< "\nNodes explored: " << nodes_explored()
 			<< "\nOptimal solution: z = " << _best_value << "\n";
 		if (_items.size() <= 10) {
 			for (size_t i = 0; i < _items.size(); ++i) {
@@ -219,7 +469,7 @@ namespace KP
 
 		// Check
 		{
-			size_t Ps = 0, Ws = 0;
+			int64_t Ps = 0, Ws = 0;
 			for (size_t i = 0; i < _items.size(); ++i)
 			{
 				if (_best_solution[i] == 1)
@@ -0,0 +1,218 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+
+
+namespace KP
+{
+	// Upper bound of Dantzig for the items in 'items', weights can be zero or negative.
+	// Expected O(n): the critical item is found by repeatedly partitioning around the efficiency of a pivot.
+	static int64_t lp_bound(std::vector<Item>& items, int64_t capacity)
+	{
+		int64_t value = 0;
+
+		// items without a positive weight are always added
+		auto first = std::partition(items.begin(), items.end(), [](const Item& a) { return a.weight <= 0; });
+		for (auto it = items.begin(); it != first; ++it)
+		{
+			value += it->value;
+			capacity -= it->weight;
+		}
+		if (capacity < 0)
+			return std::numeric_limits<int64_t>::min(); // no solution satisfies the constraint
+
+		auto last = items.end();
+		while (first != last)
+		{
+			Item pivot = *(first + (last - first) / 2);
+			auto more_efficient = std::partition(first, last, [&pivot](const Item& a)
+				{ return static_cast<int64_t>(a.value) * pivot.weight > static_cast<int64_t>(pivot.value) * a.weight; });
+			auto less_efficient = std::partition(more_efficient, last, [&pivot](const Item& a)
+				{ return static_cast<int64_t>(a.value) * pivot.weight == static_cast<int64_t>(pivot.value) * a.weight; });
+
+			int64_t P = 0, W = 0;
+			for (auto it = first; it != more_efficient; ++it)
+			{
+				P += it->value;
+				W += it->weight;
+			}
+			if (W > capacity)
+			{
+				last = more_efficient;
+				continue;
+			}
+			value += P;
+			capacity -= W;
+
+			P = 0, W = 0;
+			for (auto it = more_efficient; it != less_efficient; ++it)
+			{
+				P += it->value;
+				W += it->weight;
+			}
+			if (W >= capacity)
+				return value + capacity * pivot.value / pivot.weight;
+			value += P;
+			capacity -= W;
+
+			first = less_efficient;
+		}
+
+		return value;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	void Combo::pairing(int64_t s, int64_t t)
+	{
+		// Try to improve the lower bound by combining every state with a single item outside the core:
+		// states below capacity get the most profitable item j >= t that still fits,
+		// states above capacity lose the least profitable item j <= s that makes them feasible.
+		std::vector<size_t> order, best;
+
+		// items after the core, sorted by weight, with the most profitable item among the lightest ones
+		for (size_t j = t; j < _items.size(); ++j)
+			order.push_back(j);
+		std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return _items[a].weight < _items[b].weight; });
+		best = order;
+		for (size_t i = 1; i < best.size(); ++i)
+			if (_items[best[i - 1]].value > _items[best[i]].value)
+				best[i] = best[i - 1];
+
+		for (auto&& state : _states)
+		{
+			if (state.weight > _capacity)
+				continue;
+
+			int64_t residual = _capacity - state.weight;
+			size_t k = std::partition_point(order.begin(), order.end(), [this, residual](size_t j) { return _items[j].weight <= residual; }) - order.begin();
+			if (k == 0)
+				continue;
+
+			size_t j = best[k - 1];
+			if (state.profit + _items[j].value > _best_value)
+			{
+				_best_value = state.profit + _items[j].value;
+				_best_trail = _trail.add(static_cast<int>(j), state.trail);
+				_output << "\nNew best solution found with z = " << _best_value << " by pairing with item " << j + 1;
+			}
+		}
+
+		// items before the core, sorted by weight, with the least profitable item among the heaviest ones
+		order.clear();
+		for (int64_t j = 0; j <= s; ++j)
+			order.push_back(j);
+		std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return _items[a].weight < _items[b].weight; });
+		best = order;
+		for (size_t i = best.size(); i-- > 1; )
+			if (_items[best[i]].value < _items[best[i - 1]].value)
+				best[i - 1] = best[i];
+
+		for (auto&& state : _states)
+		{
+			if (state.weight <= _capacity)
+				continue;
+
+			int64_t excess = state.weight - _capacity;
+			size_t k = std::partition_point(order.begin(), order.end(), [this, excess](size_t j) { return _items[j].weight < excess; }) - order.begin();
+			if (k == order.size())
+				continue;
+
+			size_t j = best[k];
+			if (state.profit - _items[j].value > _best_value)
+			{
+				_best_value = state.profit - _items[j].value;
+				_best_trail = _trail.add(static_cast<int>(j), state.trail);
+				_output << "\nNew best solution found with z = " << _best_value << " by pairing with item " << j + 1;
+			}
+		}
+	}
+
+
+	int64_t Combo::surrogate_bound()
+	{
+		// At most k_max items fit in the knapsack, and a solution better than z needs at least k_min items.
+		// Both cardinality constraints are added to the capacity constraint with a surrogate multiplier lambda,
+		// which is chosen to minimize the bound of Dantzig of the surrogate problem.
+		int64_t k_max = 0, k_min = 0;
+		int wmax = 0;
+		{
+			std::vector<int> values;
+			std::vector<int> weights;
+			for (auto&& i : _items)
+			{
+				values.push_back(i.value);
+				weights.push_back(i.weight);
+				wmax = std::max(wmax, i.weight);
+			}
+
+			std::sort(weights.begin(), weights.end());
+			int64_t W = 0;
+			while (k_max < static_cast<int64_t>(weights.size()) && W + weights[k_max] <= _capacity)
+				W += weights[k_max++];
+
+			std::sort(values.begin(), values.end(), std::greater<int>());
+			int64_t P = 0;
+			while (P <= _best_value)
+			{
+				if (k_min == static_cast<int64_t>(values.size()))
+					return _best_value; // no better solution exists
+				P += values[k_min++];
+			}
+		}
+
+		std::vector<Item> surrogate(_items.size());
+		auto bound = [this, &surrogate](int64_t lambda, int64_t k)
+			{
+				// sum_j (w_j + lambda) x_j <= C + lambda k
+				for (size_t j = 0; j < _items.size(); ++j)
+					surrogate[j] = { _items[j].number, _items[j].value, static_cast<int>(_items[j].weight + lambda) };
+				return lp_bound(surrogate, _capacity + lambda * k);
+			};
+		auto minimize = [](int64_t lo, int64_t hi, auto f)
+			{
+				int64_t best = f(lo);
+				while (hi - lo > 2)
+				{
+					int64_t m1 = lo + (hi - lo) / 3, m2 = hi - (hi - lo) / 3;
+					int64_t f1 = f(m1), f2 = f(m2);
+					best = std::min(best, std::min(f1, f2));
+					if (f1 <= f2)
+						hi = m2;
+					else
+						lo = m1;
+				}
+				for (int64_t m = lo; m <= hi; ++m)
+					best = std::min(best, f(m));
+				return best;
+			};
+
+		int64_t max_card = minimize(0, 2 * wmax, [&](int64_t lambda) { return bound(lambda, k_max); });
+		int64_t min_card = minimize(0, 2 * wmax, [&](int64_t lambda) { return bound(-lambda, k_min); });
+
+		_output << "\nSurrogate relaxation: k_max = " << k_max << ", U = " << max_card
+			<< ", k_min = " << k_min << ", U = " << min_card;
+
+		return std::min(max_card, std::max(_best_value, min_card));
+	}
+
+
+	void Combo::tighten_bounds(int64_t s, int64_t t)
+	{
+		pairing(s, t);
+		_upper_bound = std::min(_upper_bound, surrogate_bound());
+	}
+
+
+	void Combo::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nStarting the combo algorithm of Martello, Pisinger and Toth ...";
+		_output.set_on(verbose);
+
+		solve("Combo");
+	}
+
+}
\ No newline at end of file
@@ -1,6 +1,13 @@
 #include "algorithms.h"
 #include <chrono>
 #include <stdexcept>
+#include <cstdint>
+#include <queue>
+#include <tuple>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <thread>
 
 
 
@@ -47,10 +54,312 @@ namespace KP
 			item_selected.pop_back();
 	}
 
+	std::vector<CompleteEnumeration::Subset> CompleteEnumeration::enumerate_subsets(size_t first, size_t last)
+	{
+		// The subsets of items first, ..., last-1 that fit in the knapsack, sorted by weight.
+		// Every item is added by merging the list with the same list shifted by the weight of the item,
+		// and only subsets with a higher profit than all lighter subsets are kept (the others can never be better).
+		std::vector<Subset> subsets{ { 0, 0, 0 } }, merged;
+
+		for (size_t j = first; j < last; ++j)
+		{
+			const int64_t value = _items[j].value;
+			const int64_t weight = _items[j].weight;
+			const uint64_t bit = uint64_t(1) << (j - first);
+
+			merged.clear();
+			merged.reserve(2 * subsets.size());
+
+			size_t a = 0, b = 0;
+			int64_t last_profit = -1;
+			while (a < subsets.size())
+			{
+				Subset next;
+				if (b < subsets.size() && subsets[b].weight + weight <= _capacity
+					&& (subsets[b].weight + weight < subsets[a].weight
+						|| (subsets[b].weight + weight == subsets[a].weight && subsets[b].profit + value > subsets[a].profit)))
+				{
+					next = { subsets[b].profit + value, subsets[b].weight + weight, subsets[b].items | bit };
+					++b;
+				}
+				else
+					next = subsets[a++];
+
+				if (next.profit > last_profit)
+				{
+					last_profit = next.profit;
+					merged.push_back(next);
+				}
+			}
+			for (; b < subsets.size() && subsets[b].weight + weight <= _capacity; ++b)
+			{
+				if (subsets[b].profit + value > last_profit)
+				{
+					last_profit = subsets[b].profit + value;
+					merged.push_back({ last_profit, subsets[b].weight + weight, subsets[b].items | bit });
+				}
+			}
+
+			subsets.swap(merged);
+		}
+
+		return subsets;
+	}
+
+
+	void CompleteEnumeration::meet_in_the_middle()
+	{
+		const size_t n = _items.size();
+		const size_t half = n / 2;
+		if (n - half > 64)
+			throw std::invalid_argument("KP::CompleteEnumeration::meet_in_the_middle: At most 128 items can be enumerated");
+
+		std::vector<Subset> left = enumerate_subsets(0, half);
+		std::vector<Subset> right = enumerate_subsets(half, n);
+		_output << "\nItems 1 to " << half << ": " << left.size() << " undominated subsets"
+			<< "\nItems " << half + 1 << " to " << n << ": " << right.size() << " undominated subsets";
+
+		// Both lists are sorted by weight with increasing profits, so the best partner of a subset of the left half
+		// is the heaviest subset of the right half that still fits, which only gets lighter for heavier left subsets
+		size_t best_left = 0, best_right = 0;
+		_best_value = -1;
+		size_t k = right.size();
+		for (size_t i = 0; i < left.size(); ++i)
+		{
+			while (k > 0 && left[i].weight + right[k - 1].weight > _capacity)
+				--k;
+			if (k == 0)
+				break;
+
+			if (left[i].profit + right[k - 1].profit > _best_value)
+			{
+				_best_value = left[i].profit + right[k - 1].profit;
+				best_left = i;
+				best_right = k - 1;
+				_output << "\nNew best solution found with z = " << _best_value;
+			}
+		}
+
+		_best_solution.assign(n, 0);
+		for (size_t j = 0; j < half; ++j)
+			_best_solution[j] = (left[best_left].items >> j) & 1;
+		for (size_t j = half; j < n; ++j)
+			_best_solution[j] = (right[best_right].items >> (j - half)) & 1;
+	}
+
+
+	void CompleteEnumeration::schroeppel_shamir()
+	{
+		// The items are split in four quarters A, B, C and D. Instead of storing all subsets of A+B and C+D,
+		// the sums of A+B are generated from heavy to light with a heap that holds one pair (a, b) for every a,
+		// and the sums of C+D from light to heavy in the same way. A lighter sum of A+B leaves more capacity, so every
+		// sum of C+D that fits once keeps fitting, and only the best profit of these sums has to be remembered.
+		const size_t n = _items.size();
+		const size_t bounds[5] = { 0, n / 4, n / 2, n / 2 + (n - n / 2) / 2, n };
+		if (bounds[4] - bounds[3] > 64)
+			throw std::invalid_argument("KP::CompleteEnumeration::schroeppel_shamir: At most 256 items can be enumerated");
+
+		std::vector<Subset> quarters[4];
+		for (int q = 0; q < 4; ++q)
+		{
+			quarters[q] = enumerate_subsets(bounds[q], bounds[q + 1]);
+			_output << "\nItems " << bounds[q] + 1 << " to " << bounds[q + 1] << ": " << quarters[q].size() << " undominated subsets";
+		}
+		const std::vector<Subset>& A = quarters[0];
+		const std::vector<Subset>& B = quarters[1];
+		const std::vector<Subset>& C = quarters[2];
+		const std::vector<Subset>& D = quarters[3];
+
+		// heap entries (weight, index in A or C, index in B or D)
+		using Entry = std::tuple<int64_t, size_t, size_t>;
+		std::priority_queue<Entry> left; // heaviest sum on top
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> right; // lightest sum on top
+		for (size_t a = 0; a < A.size(); ++a)
+			left.push({ A[a].weight + B.back().weight, a, B.size() - 1 });
+		for (size_t c = 0; c < C.size(); ++c)
+			right.push({ C[c].weight + D.front().weight, c, 0 });
+
+		int64_t best_right_profit = -1;
+		size_t best_c = 0, best_d = 0;
+		size_t best[4] = { 0, 0, 0, 0 };
+		_best_value = -1;
+		size_t nb_sums = 0;
+
+		while (!left.empty())
+		{
+			auto [weight, a, b] = left.top();
+			left.pop();
+			if (b > 0)
+				left.push({ A[a].weight + B[b - 1].weight, a, b - 1 });
+			++nb_sums;
+
+			if (weight > _capacity)
+				continue;
+
+			// add the sums of C+D that fit together with this sum of A+B
+			while (!right.empty() && std::get<0>(right.top()) + weight <= _capacity)
+			{
+				auto [right_weight, c, d] = right.top();
+				right.pop();
+				if (d + 1 < D.size())
+					right.push({ C[c].weight + D[d + 1].weight, c, d + 1 });
+				++nb_sums;
+
+				if (C[c].profit + D[d].profit > best_right_profit)
+				{
+					best_right_profit = C[c].profit + D[d].profit;
+					best_c = c;
+					best_d = d;
+				}
+			}
+
+			if (best_right_profit >= 0 && A[a].profit + B[b].profit + best_right_profit > _best_value)
+			{
+				_best_value = A[a].profit + B[b].profit + best_right_profit;
+				best[0] = a;
+				best[1] = b;
+				best[2] = best_c;
+				best[3] = best_d;
+				_output << "\nNew best solution found with z = " << _best_value;
+			}
+		}
+		_output << "\nSums of two quarters generated: " << nb_sums;
+
+		_best_solution.assign(n, 0);
+		for (int q = 0; q < 4; ++q)
+			for (size_t j = bounds[q]; j < bounds[q + 1]; ++j)
+				_best_solution[j] = (quarters[q][best[q]].items >> (j - bounds[q])) & 1;
+	}
+
+
+	void CompleteEnumeration::gray_code()
+	{
+		// The items are divided in three groups:
+		// - the first L items are the lanes: the value and weight of all their 2^L subsets are precomputed,
+		//   so that all lanes can be checked at once in a loop that the compiler vectorizes
+		// - the next G items are enumerated in Gray-code order, so only one item changes between two subsets
+		//   and the value and weight are updated in O(1)
+		// - the last items are fixed in every range, the ranges are divided over the threads
+		const size_t n = _items.size();
+		if (n > 62)
+			throw std::invalid_argument("KP::CompleteEnumeration::gray_code: At most 62 items can be enumerated");
+
+		const size_t lane_bits = std::min<size_t>(n, 8);
+		const size_t range_bits = std::min<size_t>(n - lane_bits, 8);
+		const size_t gray_bits = n - lane_bits - range_bits;
+		const size_t nb_lanes = size_t(1) << lane_bits;
+		const uint64_t nb_ranges = uint64_t(1) << range_bits;
+
+		std::vector<int64_t> lane_value(nb_lanes, 0), lane_weight(nb_lanes, 0);
+		for (size_t lane = 1; lane < nb_lanes; ++lane)
+		{
+			size_t j = std::countr_zero(lane);
+			lane_value[lane] = lane_value[lane & (lane - 1)] + _items[j].value;
+			lane_weight[lane] = lane_weight[lane & (lane - 1)] + _items[j].weight;
+		}
+
+		struct Best
+		{
+			int64_t value = -1;
+			uint64_t items = 0;
+		};
+		std::vector<Best> best(nb_ranges);
+		std::atomic<uint64_t> next_range = 0;
+
+		auto enumerate_ranges = [&]()
+			{
+				const int64_t capacity = _capacity;
+				for (uint64_t range = next_range++; range < nb_ranges; range = next_range++)
+				{
+					uint64_t items = range << (lane_bits + gray_bits);
+					int64_t value = 0, weight = 0;
+					for (size_t j = lane_bits + gray_bits; j < n; ++j)
+					{
+						if ((items >> j) & 1)
+						{
+							value += _items[j].value;
+							weight += _items[j].weight;
+						}
+					}
+
+					Best local;
+					for (uint64_t code = 0; ; )
+					{
+						if (weight <= capacity)
+						{
+							int64_t max_value = -1;
+							for (size_t lane = 0; lane < nb_lanes; ++lane)
+							{
+								int64_t lane_total = weight + lane_weight[lane] <= capacity ? value + lane_value[lane] : -1;
+								max_value = std::max(max_value, lane_total);
+							}
+
+							if (max_value > local.value)
+							{
+								size_t lane = 0;
+								while (weight + lane_weight[lane] > capacity || value + lane_value[lane] != max_value)
+									++lane;
+								local = { max_value, items | lane };
+							}
+						}
+
+						if (++code == uint64_t(1) << gray_bits)
+							break;
+
+						// the lowest set bit of the counter is the item that changes in the Gray code
+						size_t j = lane_bits + std::countr_zero(code);
+						items ^= uint64_t(1) << j;
+						if ((items >> j) & 1)
+						{
+							value += _items[j].value;
+							weight += _items[j].weight;
+						}
+						else
+						{
+							value -= _items[j].value;
+							weight -= _items[j].weight;
+						}
+					}
+					best[range] = local;
+				}
+			};
+
+		const size_t max_threads = _threads > 0 ? _threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+		const size_t nb_threads = std::max<size_t>(1, std::min<uint64_t>(max_threads, nb_ranges));
+		std::vector<std::thread> threads;
+		for (size_t t = 1; t < nb_threads; ++t)
+			threads.emplace_back(enumerate_ranges);
+		enumerate_ranges();
+		for (auto&& thread : threads)
+			thread.join();
+
+		// the first range with the best value, so that the solution does not depend on the threads
+		Best overall;
+		for (auto&& b : best)
+			if (b.value > overall.value)
+				overall = b;
+		_best_value = overall.value;
+
+		_output << "\n" << nb_threads << " threads, " << nb_ranges << " ranges of " << (uint64_t(1) << gray_bits)
+			<< " x " << nb_lanes << " subsets";
+
+		_best_solution.assign(n, 0);
+		for (size_t j = 0; j < n; ++j)
+			_best_solution[j] = (overall.items >> j) & 1;
+	}
+
+
 	void CompleteEnumeration::run(bool verbose)
 	{
 		_output.set_on(true);
-		_output << "\n\n\nComplete enumeration:\n";
+		if (_mode == Mode::meet_in_the_middle)
+			_output << "\n\n\nComplete enumeration with the meet-in-the-middle method of Horowitz and Sahni:\n";
+		else if (_mode == Mode::schroeppel_shamir)
+			_output << "\n\n\nComplete enumeration with the method of Schroeppel and Shamir:\n";
+		else if (_mode == Mode::gray_code)
+			_output << "\n\n\nComplete enumeration in Gray-code order:\n";
+		else
+			_output << "\n\n\nComplete enumeration:\n";
 		_output.set_on(verbose);
 
 
@@ -60,10 +369,25 @@ namespace KP
 		_best_solution.clear();
 		_best_value = 0;
 
-		std::vector<int> vec;
-		vec.reserve(_items.size());
+		if (_mode == Mode::meet_in_the_middle)
+		{
+			meet_in_the_middle();
+		}
+		else if (_mode == Mode::schroeppel_shamir)
+		{
+			schroeppel_shamir();
+		}
+		else if (_mode == Mode::gray_code)
+		{
+			gray_code();
+		}
+		else
+		{
+			std::vector<int> vec;
+			vec.reserve(_items.size());
 
-		complete_enumeration_imp(vec);
+			complete_enumeration_imp(vec);
+		}
 
 		_output.set_on(true);
 		_output << "\n\nBest solution:";
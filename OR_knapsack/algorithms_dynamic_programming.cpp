@@ -2,111 +2,139 @@
 #include <chrono>
 #include <stdexcept>
 #include <algorithm>
+#include <limits>
 
 
 
 namespace KP
 {
-	void DPCapacity::run(bool verbose)
+	void DPCapacity::ring(size_t nb_stages, int64_t block, bool verbose)
 	{
-		_output.set_on(true);
-		_output << "\n\n\nDynamic programming with a stage for every residual capacity ...";
-		_output.set_on(verbose);
-
-		auto start_time = std::chrono::system_clock::now();
-		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
-
-		// initialize
-		_best_solution.reserve(_items.size());
-		for (size_t i = 0; i < _items.size(); ++i)
-			_best_solution.push_back(0);
+		// g_d(j) = best profit of the items 1 .. j with an availability of d, so that item j can only be added once.
+		// Stage d only uses the stages d - w_j, so the stages are computed in blocks of 'block' stages and the last
+		// nb_stages >= wmax + block stages are kept in a ring. Within a block the items are the outer loop, the values
+		// g_d(j) of the same j are contiguous, so that both g_d(j) and g_{d - w_j}(j) are swept in order.
+		const size_t n = _items.size();
+		std::vector<int64_t> stages(nb_stages * (n + 1), 0); // g_d(0) = 0 is never overwritten
+
+		// add[d][j] == 1 if item j is added in g_d(j), only stored if it fits in memory
+		const size_t words_per_stage = n / 64 + 1;
+		const bool store_decisions = words_per_stage * static_cast<size_t>(_capacity + 1) <= (size_t(1) << 25);
+		std::vector<uint64_t> add;
+		if (store_decisions)
+			add.assign(words_per_stage * static_cast<size_t>(_capacity + 1), 0);
 
 		// forward arcs
-		struct Stage
+		for (int64_t first = 0; first <= _capacity; first += block)
 		{
-			int64_t best_profit;
-			int64_t best_item = -1;
-			std::vector<int> items_already_added;
-		};
-		std::vector<Stage> stages;
+			const int64_t last = std::min(_capacity, first + block - 1);
+			if (verbose) // one stage per block
+				_output << "\n\nWe go to the next stage with an availability of " << first;
 
-		for (size_t available = 0; available <= _capacity; ++available)
-		{
-			_output << "\n\nWe go to the next stage with an availability of " << available;
-
-			int best_profit = 0;
-			int best_item = -1;
-			int best_residualcap = 0;
-			for (size_t j = 0; j < _items.size(); ++j)
+			for (size_t j = 0; j < n; ++j)
 			{
-				int residualcap = available - _items[j].weight;
-
-				bool item_not_yet_added = true;
-				if (residualcap >= 0) {
-					for (auto&& k : stages[residualcap].items_already_added) {
-						if (k == j) {
-							item_not_yet_added = false;
-							break;
+				const int64_t value = _items[j].value;
+				const int64_t weight = _items[j].weight;
+				const int64_t* previous = &stages[j * nb_stages];
+				int64_t* current = &stages[(j + 1) * nb_stages];
+
+				int64_t slot = first % nb_stages;
+				for (int64_t available = first; available <= last; ++available)
+				{
+					current[slot] = previous[slot];
+
+					int64_t residualcap = available - weight;
+					if (residualcap < 0)
+					{
+						if (verbose)
+							_output << "\nWe cannot add item " << j + 1 << " because there is not sufficient capacity left";
+					}
+					else
+					{
+						const int64_t residual_slot = slot >= weight ? slot - weight : slot + static_cast<int64_t>(nb_stages) - weight;
+						int64_t profit = value + previous[residual_slot];
+						if (verbose)
+							_output << "\nIf we add item " << j + 1 << " the profit is p[" << j + 1 << "] + g_" << j << "(" << residualcap << ") = "
+							<< value << " + " << previous[residual_slot] << " = " << profit
+							<< ", otherwise g_" << j << "(" << available << ") = " << previous[slot];
+
+						if (profit > current[slot])
+						{
+							current[slot] = profit;
+							if (store_decisions)
+								add[available * words_per_stage + j / 64] |= uint64_t(1) << (j % 64);
 						}
 					}
-				}
 
-				if (residualcap >= 0
-					&& _items[j].value + stages[residualcap].best_profit > best_profit
-					&& item_not_yet_added)
-				{
-					best_profit = _items[j].value + stages[residualcap].best_profit;
-					best_item = j;
-					best_residualcap = residualcap;
+					if (++slot == static_cast<int64_t>(nb_stages))
+						slot = 0;
 				}
-
-				if (residualcap < 0)
-					_output << "\nWe cannot add item " << j + 1 << " because there is not sufficient capacity left";
-				else if (!item_not_yet_added)
-					_output << "\nWe cannot add item " << j + 1 << " because it was already added in a previous stage";
-				else
-					_output << "\nIf we add item " << j + 1 << " the profit is p[" << j + 1 <<
-					"] + g(" << residualcap << ") = " << _items[j].value << " + "
-					<< stages[residualcap].best_profit << " = " << _items[j].value + stages[residualcap].best_profit;
 			}
-			stages.push_back(Stage());
-			stages.back().best_item = best_item;
-			stages.back().best_profit = best_profit;
-			stages.back().items_already_added = stages[best_residualcap].items_already_added;
-			stages.back().items_already_added.push_back(best_item);
 
-			_output << "\nThe best choice is thus to add item " << best_item + 1 <<
-				" for a profit of g(" << available << ") = " << best_profit << "\nItems added: {";
-			for (auto&& mm : stages.back().items_already_added)
-				if (mm >= 0)
-					_output << " " << mm + 1;
-			_output << " }";
+			if (verbose)
+				_output << "\nThe best profit is thus g(" << first << ") = " << stages[n * nb_stages + first % nb_stages];
 		}
+		_best_value = stages[n * nb_stages + _capacity % nb_stages];
 
 		// reconstruct solution
-		_output.set_on(true);
-		_output << "\n\nThe optimal solution is:";
-		_output << "\n\tz = " << stages[_capacity].best_profit << "\n";
-
-		if (_items.size() <= 20)
+		if (store_decisions)
 		{
-			int64_t residualcap = _capacity;
-
-			int minweight = std::numeric_limits<int>::max();
-			for (auto&& i : _items)
-				if (i.weight < minweight)
-					minweight = i.weight;
-
-			while (residualcap >= minweight)
+			int64_t available = _capacity;
+			for (size_t j = n; j-- > 0; )
 			{
-				if (stages[residualcap].best_item >= 0)
-					_best_solution[stages[residualcap].best_item] = 1;
-				residualcap -= _items[stages[residualcap].best_item].weight;
+				if (add[available * words_per_stage + j / 64] >> (j % 64) & 1)
+				{
+					_best_solution[j] = 1;
+					available -= _items[j].weight;
+				}
 			}
-			if (_items.size() <= 10)
-				for (size_t j = 0; j < _items.size(); ++j)
-					_output << "\tx[" << j + 1 << "] = " << _best_solution[j];
 		}
+		else
+		{
+			_output << "\n\nThe decisions don't fit in memory: recovering the solution by divide and conquer";
+			recover_solution(0, n, _capacity);
+		}
+	}
+
+
+	void DPCapacity::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nDynamic programming with a stage for every residual capacity ...";
+		_output.set_on(verbose);
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+		// initialize
+		const size_t n = _items.size();
+		_best_solution.assign(n, 0);
+
+		// blocks of stages without explanations, the ring holds wmax + block stages
+		int64_t wmax = 0;
+		for (auto&& i : _items)
+			wmax = std::max<int64_t>(wmax, i.weight);
+		const int64_t block = verbose ? 1 : 1024;
+		const size_t nb_stages = static_cast<size_t>(std::min(wmax + block, _capacity + 1));
+		if (nb_stages * (n + 1) <= (size_t(1) << 25))
+		{
+			ring(nb_stages, block, verbose);
+		}
+		else
+		{
+			_output << "\n\nThe stages don't fit in memory: using one row of states for the residual capacity and divide and conquer";
+			std::vector<int64_t> profits;
+			best_profits(0, n, _capacity, profits);
+			_best_value = profits[_capacity];
+			recover_solution(0, n, _capacity);
+		}
+
+		_output.set_on(true);
+		_output << "\n\nThe optimal solution is:";
+		_output << "\n\tz = " << _best_value << "\n";
+		if (n <= 10)
+			for (size_t j = 0; j < n; ++j)
+				_output << "\tx[" << j + 1 << "] = " << _best_solution[j];
 
 		elapsed_time = std::chrono::system_clock::now() - start_time;
 		_output << "\n\nComputation time (s): " << elapsed_time.count();
@@ -114,133 +142,294 @@ namespace KP
 
 	///////////////////////////////////////////////////////////////////////////
 
+	void DPItems::rolling()
+	{
+		const size_t n = _items.size();
+		_best_solution.assign(n, 0);
+
+		std::vector<int64_t> profits;
+		best_profits(0, n, _capacity, profits);
+		_best_value = profits[_capacity];
+		_output << "\n\nThe best profit with one row of states for the residual capacity: f(" << _capacity << ") = " << _best_value;
+
+		_output << "\n\nRecovering the solution by dividing the items and the capacity ...";
+		recover_solution(0, n, _capacity);
+
+		_output.set_on(true);
+		_output << "\n\n\nThe optimal solution has been identified.\n\tz = " << _best_value;
+		if (n <= 20)
+		{
+			_output << "\n";
+			for (size_t j = 0; j < n; ++j)
+				_output << "\tx[" << j + 1 << "] = " << _best_solution[j];
+		}
+	}
+
+
 	void DPItems::run(bool verbose)
 	{
 		_output.set_on(true);
-		_output << "\n\n\nDynamic programming with a stage for every item and states for the residual capacity ...";
+		if (_mode == Mode::rolling)
+			_output << "\n\n\nDynamic programming with a stage for every item and one row of states for the residual capacity ...";
+		else
+			_output << "\n\n\nDynamic programming with a stage for every item and states for the residual capacity ...";
+		_output << "\nRow updates with " << RowKernels::name(RowKernels::instruction_set());
 		_output.set_on(verbose);
 
 		auto start_time = std::chrono::system_clock::now();
 		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
 
+		if (_mode == Mode::rolling)
+		{
+			rolling();
 
-		// Nodes to save states
-		struct Node
-		{
-			int stage = -1;
-			int available = -1;
-			int bestprofit = -1;
-			int amount = 0;
-		};
-		std::vector<std::vector<Node>> states;
-		states.push_back(std::vector<Node>());
-		for (int stage = 1; stage < _items.size(); ++stage) {
-			states.push_back(std::vector<Node>());
-			for (size_t available = 0; available <= _capacity; ++available) {
-				states.back().push_back(Node());
-			}
+			elapsed_time = std::chrono::system_clock::now() - start_time;
+			_output << "\n\nComputation time (s): " << elapsed_time.count();
+			return;
+		}
+
+
+		// f(d) = best profit of the items of the next stages with an availability of d, one row that is updated for every stage
+		// take[stage][d] == 1 if the best choice at stage 'stage' with an availability of d is x = 1
+		const size_t n = _items.size();
+		const size_t words_per_stage = static_cast<size_t>(_capacity) / 64 + 1;
+		if (words_per_stage * n > (size_t(1) << 25))
+		{
+			_output << "\n\nThe decisions don't fit in memory: using one row of states and divide and conquer";
+			rolling();
+
+			elapsed_time = std::chrono::system_clock::now() - start_time;
+			_output << "\n\nComputation time (s): " << elapsed_time.count();
+			return;
 		}
+		std::vector<int64_t> profits(_capacity + 1, 0);
+		std::vector<uint64_t> take(words_per_stage * n, 0);
 
 
-		// stages from last until second
-		for (int stage = _items.size() - 1; stage > 0; --stage)
+		// stages from last until first
+		for (size_t stage = n; stage-- > 0; )
 		{
+			// without explanations the whole row is updated at once with the vector instructions
+			if (!verbose)
+			{
+				RowKernels::add_item(profits.data(), _capacity, _items[stage], &take[stage * words_per_stage]);
+				continue;
+			}
+
+			const int64_t value = _items[stage].value;
+			const int64_t weight = _items[stage].weight;
+
 			_output << "\n\n\nWe go to stage " << stage + 1;
-			if (stage == _items.size() - 1)
+			if (stage == n - 1)
 				_output << "\nThis is the final stage, so we don't have to take other stage into account.";
 
-			for (int available = 0; available <= _capacity; ++available)
+			// at the first stage only an availability of C is needed
+			const int64_t lowest = stage == 0 ? _capacity : 0;
+			if (stage == 0)
+				_output << "\nWe are now at stage 1, so we only need to look at an availability of " << _capacity;
+
+			// from high to low availability, so that f(d - w) still belongs to the next stage
+			for (int64_t available = _capacity; available >= lowest; --available)
 			{
-				// last stage
-				if (stage == _items.size() - 1)
+				int maxcurrent = available >= weight ? 1 : 0;
+				int64_t profit = maxcurrent == 1 ? value + profits[available - weight] : 0;
+				_output << "\n\nFor d = " << available << ", we can add item " << stage + 1 << " at most " << maxcurrent << " times.";
+				_output << "\nIf we set x[" << stage + 1 << "] = 0, the profit is f_" << stage + 2 << "(" << available << ") = " << profits[available];
+				if (maxcurrent == 1)
+					_output << "\nIf we set x[" << stage + 1 << "] = 1, the profit is " << value << " + f_" << stage + 2
+					<< "(" << available - weight << ") = " << profit;
+
+				if (maxcurrent == 1 && profit > profits[available])
 				{
-					// maximum 1 item
-					int amountcurrent = std::min(available / _items[stage].weight, 1);
-					int profit = amountcurrent * _items[stage].value;
-
-					states[stage][available].stage = stage;
-					states[stage][available].available = available;
-					states[stage][available].amount = amountcurrent;
-					states[stage][available].bestprofit = profit;
-
-					_output << "\n\nFor d = " << available << ", we can add item " << stage + 1 << " at most " << amountcurrent
-						<< " times, for a profit of " << profit;
-					_output << "\nThen f_" << stage + 1 << "(" << available << ") = " << states[stage][available].bestprofit;
+					profits[available] = profit;
+					take[stage * words_per_stage + available / 64] |= uint64_t(1) << (available % 64);
 				}
-				else
-				{
-					// max 1 item
-					int maxcurrent = std::min(available / _items[stage].weight, 1);
-					_output << "\n\nFor d = " << available << ", we can add item " << stage + 1 << " at most " << maxcurrent << " times.";
 
-					for (int amountcurrent = 0; amountcurrent <= maxcurrent; ++amountcurrent)
-					{
-						int residualcap = available - amountcurrent * _items[stage].weight;
-						int profit = amountcurrent * _items[stage].value + states[stage + 1][residualcap].bestprofit;
+				_output << "\nThe best choice at this stage when d = " << available << " is thus x[" << stage + 1 << "] = "
+				<< (take[stage * words_per_stage + available / 64] >> (available % 64) & 1)
+				<< " for a profit of f_" << stage + 1 << "(" << available << ") = " << profits[available];
+			}
+		}
 
-						_output << "\nIf we set x[" << stage + 1 << "] = " << amountcurrent << ", then the residual capacity is " << residualcap;
-						_output << "\nThe profit is then " << amountcurrent << " * " << _items[stage].value << " + f_" << stage + 2 << "(" << residualcap << ") = " << profit;
 
-						if (profit > states[stage][available].bestprofit)
-						{
-							states[stage][available].stage = stage;
-							states[stage][available].available = available;
-							states[stage][available].amount = amountcurrent;
-							states[stage][available].bestprofit = profit;
-						}
-					}
+		// reconstruct solution
+		_best_value = profits[_capacity];
+		_best_solution.assign(n, 0);
+		int64_t available = _capacity;
+		for (size_t stage = 0; stage < n; ++stage)
+		{
+			if (take[stage * words_per_stage + available / 64] >> (available % 64) & 1)
+			{
+				_best_solution[stage] = 1;
+				available -= _items[stage].weight;
+			}
+		}
+
+		_output.set_on(true);
+		_output << "\n\n\nThe optimal solution has been identified.\n\tz = " << _best_value;
+		if (n <= 20)
+		{
+			_output << "\n";
+			for (size_t stage = 0; stage < n; ++stage)
+				_output << "\tx[" << stage + 1 << "] = " << _best_solution[stage];
+		}
 
-					_output << "\nThe best choice at this stage when d = " << available << " is thus x[" << stage+1 <<
-						"] = " << states[stage][available].amount << " for a profit of " << states[stage][available].bestprofit;
-					_output << "\nWe save f_" << stage+1 << "(" << available << ") = " << states[stage][available].bestprofit;
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output << "\n\nComputation time (s): " << elapsed_time.count();
+	}
 
-				}
-			}
+	///////////////////////////////////////////////////////////////////////////
+
+	void DPProfits::min_weights(size_t first, size_t last, int64_t max_profit, std::vector<int64_t>& minweight) const
+	{
+		const int64_t infinity = std::numeric_limits<int64_t>::max();
+		minweight.assign(max_profit + 1, infinity);
+		minweight[0] = 0;
+		int64_t highest = 0;
+		for (size_t j = first; j < last; ++j)
+		{
+			const int64_t value = _items[j].value;
+			const int64_t weight = _items[j].weight;
+			for (int64_t profit = std::min(max_profit, highest + value); profit >= value; --profit)
+				if (minweight[profit - value] != infinity && minweight[profit - value] + weight <= _capacity
+					&& minweight[profit - value] + weight < minweight[profit])
+					minweight[profit] = minweight[profit - value] + weight;
+			highest = std::min(max_profit, highest + value);
 		}
+	}
 
-		// first stage
-		int bestprofit = 0;
-		int amount_item1 = 0;
+
+	void DPProfits::recover_by_profits(size_t first, size_t last, int64_t target, std::vector<int64_t>& forward, std::vector<int64_t>& backward)
+	{
+		// the minimum weights of both halves of the items show how the profit is divided, both halves are then
+		// solved with their part of the profit
+		if (target == 0)
+			return;
+		if (last - first == 1)
 		{
-			int stage = 0;
-			int available = _capacity;
+			_best_solution[first] = 1;
+			return;
+		}
 
-			_output << "\n\n\nWe are now at stage 1, so we only need to look at an availability of " << _capacity;
+		size_t mid = first + (last - first) / 2;
+		min_weights(first, mid, target, forward);
+		min_weights(mid, last, target, backward);
 
-			int maxcurrent = std::min(available / _items[stage].weight, 1);
-			for (int amountcurrent = 0; amountcurrent <= maxcurrent; ++amountcurrent)
-			{
-				int residualcap = available - amountcurrent * _items[stage].weight;
-				int profit = amountcurrent * _items[stage].value + states[stage + 1][residualcap].bestprofit;
+		const int64_t infinity = std::numeric_limits<int64_t>::max();
+		int64_t best_p = -1;
+		for (int64_t p = 0; p <= target; ++p)
+			if (forward[p] != infinity && backward[target - p] != infinity
+				&& (best_p < 0 || forward[p] + backward[target - p] < forward[best_p] + backward[target - best_p]))
+				best_p = p;
 
-				_output << "\nIf we set x[" << stage + 1 << "] = " << amountcurrent << ", then the residual capacity is " << residualcap;
-				_output << "\nProfit is then " << amountcurrent << " * " << _items[stage].value 
-					<< " + f_" << stage + 2 << "(" << residualcap << ") = " << profit;
+		_output << "\nItems " << first + 1 << " to " << last << " with profit " << target << ": profit "
+			<< best_p << " for items " << first + 1 << " to " << mid << " (weight " << forward[best_p] << "), "
+			<< target - best_p << " for items " << mid + 1 << " to " << last << " (weight " << backward[target - best_p] << ")";
 
-				if (profit > bestprofit)
+		recover_by_profits(first, mid, best_p, forward, backward);
+		recover_by_profits(mid, last, target - best_p, forward, backward);
+	}
+
+
+	void DPProfits::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nDynamic programming with a stage for every item and states for the profit ...";
+		_output.set_on(verbose);
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+		// The optimal profit is at most the bound of Dantzig, so only profits 0 .. U are needed
+		const int64_t max_profit = dantzig_bound();
+		const int64_t infinity = std::numeric_limits<int64_t>::max();
+		_output << "\n\nThe optimal profit is at most U = " << max_profit;
+
+		// g(p) = minimum weight of the items added so far with a total profit of exactly p
+		std::vector<int64_t> minweight(max_profit + 1, infinity);
+		minweight[0] = 0;
+		int64_t highest = 0; // highest profit with g(p) < infinity
+
+		// decision[j][p] == 1 if item j is added to reach g(p) at stage j, only stored if it fits in memory
+		const size_t words_per_stage = static_cast<size_t>(max_profit) / 64 + 1;
+		const bool store_decisions = words_per_stage * _items.size() <= (size_t(1) << 25);
+		std::vector<uint64_t> decision;
+		if (store_decisions)
+			decision.assign(words_per_stage * _items.size(), 0);
+
+
+		// stages from first item until last
+		for (size_t stage = 0; stage < _items.size(); ++stage)
+		{
+			const int64_t value = _items[stage].value;
+			const int64_t weight = _items[stage].weight;
+			_output << "\n\nWe go to stage " << stage + 1 << ": item " << stage + 1 << " has profit " << value << " and weight " << weight;
+
+			// from high to low profits, so that g(p - p_j) still belongs to the previous stage
+			for (int64_t profit = std::min(max_profit, highest + value); profit >= value; --profit)
+			{
+				if (minweight[profit - value] == infinity || minweight[profit - value] + weight > _capacity)
+					continue;
+
+				if (minweight[profit - value] + weight < minweight[profit])
 				{
-					amount_item1 = amountcurrent;
-					bestprofit = profit;
+					minweight[profit] = minweight[profit - value] + weight;
+					if (store_decisions)
+						decision[stage * words_per_stage + profit / 64] |= uint64_t(1) << (profit % 64);
+
+					_output << "\nAdding item " << stage + 1 << " gives g(" << profit << ") = g(" << profit - value << ") + "
+						<< weight << " = " << minweight[profit];
 				}
 			}
+			highest = std::min(max_profit, highest + value);
+		}
+
 
-			_output << "\nThe best choice is thus x[" << stage + 1 << "] = " << amount_item1 << " for a profit of " << bestprofit;
+		// the optimal profit is the highest profit that fits in the knapsack
+		_best_value = 0;
+		for (int64_t profit = highest; profit >= 0; --profit)
+		{
+			if (minweight[profit] <= _capacity)
+			{
+				_best_value = profit;
+				break;
+			}
 		}
 
 		// reconstruct solution
 		_output.set_on(true);
-		_output << "\n\n\nThe optimal solution has been identified.\n\tz = " << bestprofit;
+		_output << "\n\n\nThe optimal solution has been identified.\n\tz = " << _best_value
+			<< "\n\tw = " << minweight[_best_value];
 
-		if (_items.size() <= 20)
+		_best_solution.assign(_items.size(), 0);
+		if (store_decisions)
 		{
-			_output << "\n\tx[1] = " << amount_item1;
-			int available = _capacity - amount_item1 * _items[0].weight;
-			for (int stage = 1; stage < _items.size(); ++stage)
+			int64_t profit = _best_value;
+			for (size_t stage = _items.size(); stage-- > 0; )
 			{
-				_output << "\tx[" << stage + 1 << "] = " << states[stage][available].amount;
-				available -= states[stage][available].amount * _items[stage].weight;
+				if (decision[stage * words_per_stage + profit / 64] >> (profit % 64) & 1)
+				{
+					_best_solution[stage] = 1;
+					profit -= _items[stage].value;
+				}
 			}
 		}
+		else
+		{
+			_output << "\n\nThe decisions don't fit in memory: recovering the solution by divide and conquer";
+			_output.set_on(verbose);
+			std::vector<int64_t> forward, backward;
+			recover_by_profits(0, _items.size(), _best_value, forward, backward);
+			_output.set_on(true);
+		}
+
+		if (_items.size() <= 20)
+		{
+			_output << "\n";
+			for (size_t stage = 0; stage < _items.size(); ++stage)
+				_output << "\tx[" << stage + 1 << "] = " << _best_solution[stage];
+		}
 
 		elapsed_time = std::chrono::system_clock::now() - start_time;
 		_output << "\n\nComputation time (s): " << elapsed_time.count();
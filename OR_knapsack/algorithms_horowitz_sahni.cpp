@@ -0,0 +1,143 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+
+
+namespace KP
+{
+	void HorowitzSahni::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nStarting the depth-first branch-and-bound method of Horowitz and Sahni ...";
+		_output.set_on(verbose);
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize
+		const size_t n = _items.size();
+		std::vector<int> x(n, 0); // current solution
+		std::vector<size_t> added; // items with x[j] = 1, in the order in which they were added
+		added.reserve(n);
+		_best_solution.assign(n, 0);
+		_best_value = 0;
+		_nodes_explored = 0;
+
+
+
+		// 1. sort items based on efficiency (highest to lowest)
+		_output << "\n\nSorting the items from most efficient to least efficient";
+		sort_by_efficiency();
+
+
+
+		// 2. depth-first search
+		size_t j = 0; // next item
+		int64_t value = 0; // value of the current solution
+		int64_t residual = _capacity; // residual capacity of the current solution
+
+		while (true)
+		{
+			// upper bound of Dantzig for the items [j, n) with the residual capacity
+			bool backtrack = false;
+			if (j < n)
+			{
+				++_nodes_explored;
+
+				int64_t P = 0, W = 0;
+				size_t r = j;
+				while (r < n && W + _items[r].weight <= residual)
+				{
+					P += _items[r].value;
+					W += _items[r].weight;
+					++r;
+				}
+				int64_t upper_bound = value + P;
+				if (r < n)
+					upper_bound += (residual - W) * _items[r].value / _items[r].weight;
+
+				if (upper_bound <= _best_value)
+				{
+					_output << "\nItem " << j + 1 << ": upper bound " << upper_bound << " <= z = " << _best_value << ". Backtrack ...";
+					backtrack = true;
+				}
+				else
+				{
+					// forward move: add the items as long as they fit, then leave out the next one
+					while (j < n && _items[j].weight <= residual)
+					{
+						residual -= _items[j].weight;
+						value += _items[j].value;
+						x[j] = 1;
+						added.push_back(j);
+						++j;
+					}
+					if (j < n)
+					{
+						++j;
+						continue;
+					}
+				}
+			}
+
+			// all items have been considered: update the best solution
+			if (!backtrack && value > _best_value)
+			{
+				_best_value = value;
+				_best_solution = x;
+				_output << "\nNew best solution found with z = " << _best_value;
+			}
+
+			// backtrack: remove the last added item and continue without it
+			if (added.empty())
+				break;
+			size_t i = added.back();
+			added.pop_back();
+			residual += _items[i].weight;
+			value -= _items[i].value;
+			x[i] = 0; // the items after i are not in the current solution, because i was the last item added
+			j = i + 1;
+		}
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nNodes explored: " << _nodes_explored
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in HorowitzSahni: Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in HorowitzSahni: Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+
+
+namespace KP
+{
+	void Minknap::merge(size_t j, bool add)
+	{
+		// states are sorted by weight with strictly increasing profits
+		// merge them with the states in which item j is toggled, and remove dominated states
+		int64_t dp = add ? _items[j].value : -_items[j].value;
+		int64_t dw = add ? _items[j].weight : -_items[j].weight;
+		merge_states(_states, static_cast<int>(j), dp, dw, std::numeric_limits<int64_t>::max(), _trail, _buffer);
+		_states.swap(_buffer);
+	}
+
+
+	void Minknap::reduce(int64_t s, int64_t t)
+	{
+		// update the lower bound
+		for (auto&& state : _states)
+		{
+			if (state.weight <= _capacity && state.profit > _best_value)
+			{
+				_best_value = state.profit;
+				_best_trail = state.trail;
+				_output << "\nNew best solution found with z = " << _best_value;
+			}
+		}
+
+		// remove the states that cannot lead to a better solution (upper bound test)
+		// below capacity items j >= t can still be added, above capacity items j <= s have to be removed
+		size_t nb_kept = 0;
+		for (auto&& state : _states)
+		{
+			bool keep = false;
+			if (state.weight <= _capacity)
+				keep = t < static_cast<int64_t>(_items.size())
+				&& (state.profit - _best_value - 1) * _items[t].weight + (_capacity - state.weight) * _items[t].value >= 0;
+			else
+				keep = s >= 0
+				&& (state.profit - _best_value - 1) * _items[s].weight + (_capacity - state.weight) * _items[s].value >= 0;
+
+			if (keep)
+				_states[nb_kept++] = state;
+		}
+		_states.resize(nb_kept);
+	}
+
+
+	void Minknap::solve(const std::string& name)
+	{
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize
+		_best_solution.assign(_items.size(), 0);
+		_states.clear();
+		_buffer.clear();
+		_trail.clear();
+		_best_trail = -1;
+		_max_states = 0;
+		const int64_t n = _items.size();
+
+
+
+		// 1. sort items based on efficiency (highest to lowest)
+		_output << "\n\nSorting the items from most efficient to least efficient";
+		sort_by_efficiency();
+
+
+
+		// 2. find the break item
+		_output << "\n\nFinding the break item ...";
+		int64_t valuesum = 0, weightsum = 0;
+		int64_t breakitem_index = find_break_item(valuesum, weightsum);
+		_best_value = valuesum;
+		_upper_bound = valuesum;
+		if (breakitem_index < n)
+			_upper_bound += (_capacity - weightsum) * _items[breakitem_index].value / _items[breakitem_index].weight;
+		_output << "\nBreakitem = " << breakitem_index + 1 << ", Pb = " << valuesum << ", Ws = " << weightsum
+			<< "\nUpper bound of Dantzig: U = " << _upper_bound;
+
+
+
+		// 3. greedy heuristic: fill the residual capacity with the items after the break item
+		{
+			int64_t P = valuesum, W = weightsum;
+			int rec = -1;
+			for (int64_t j = breakitem_index; j < n; ++j)
+			{
+				if (W + _items[j].weight <= _capacity)
+				{
+					P += _items[j].value;
+					W += _items[j].weight;
+					rec = _trail.add(static_cast<int>(j), rec);
+				}
+			}
+			if (P > _best_value)
+			{
+				_best_value = P;
+				_best_trail = rec;
+			}
+			_output << "\nGreedy solution: z = " << _best_value;
+		}
+
+
+
+		// 4. dynamic programming over an expanding core [s+1, t-1] around the break item
+		_output << "\n\nExpanding the core ...";
+		_states.push_back({ valuesum, weightsum, -1 });
+		int64_t s = breakitem_index - 1, t = breakitem_index;
+		size_t threshold = 1000; // number of states at which the bounds are tightened
+
+		while (!_states.empty() && _best_value < _upper_bound && (s >= 0 || t < n))
+		{
+			if (t < n)
+			{
+				merge(t, true);
+				++t;
+				reduce(s, t);
+			}
+			if (s >= 0 && !_states.empty())
+			{
+				merge(s, false);
+				--s;
+				reduce(s, t);
+			}
+			_max_states = std::max(_max_states, _states.size());
+
+			_output << "\nCore = [" << s + 2 << ", " << t << "], states = " << _states.size()
+				<< ", z = " << _best_value << ", U = " << _upper_bound;
+
+			if (_states.size() > threshold)
+			{
+				tighten_bounds(s, t);
+				threshold *= 2;
+			}
+
+			if (_trail.needs_compaction())
+				_trail.compact(_states, _best_trail);
+		}
+
+
+
+		// 5. store optimal solution
+		for (int64_t i = 0; i < breakitem_index; ++i)
+			_best_solution[i] = 1;
+		_trail.apply(_best_trail, _best_solution);
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nCore size: " << t - s - 1
+			<< "\nMaximum number of states: " << _max_states
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in " << name << ": Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in " << name << ": Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+
+
+	void Minknap::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nStarting the minknap algorithm of Pisinger ...";
+		_output.set_on(verbose);
+
+		solve("Minknap");
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,329 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <cmath>
+
+
+
+namespace KP
+{
+	static bool more_efficient(const Item& a, const Item& b)
+	{
+		// items without value and weight are the least efficient, otherwise they would be equivalent to all items
+		if (a.value == 0 && a.weight == 0)
+			return false;
+		if (b.value == 0 && b.weight == 0)
+			return true;
+		return static_cast<int64_t>(a.value) * b.weight > static_cast<int64_t>(a.weight) * b.value;
+	}
+
+
+	size_t MT2::find_critical_item(int64_t& valuesum, int64_t& weightsum)
+	{
+		// Partition the items around the critical item b without sorting them: afterwards the items [0, b)
+		// are at least as efficient as item b, the items (b, n) at most, and the items [0, b) fit in the knapsack
+		size_t first = 0, last = _items.size();
+		valuesum = 0;
+		weightsum = 0;
+		while (first < last)
+		{
+			size_t middle = first + (last - first) / 2;
+			std::nth_element(_items.begin() + first, _items.begin() + middle, _items.begin() + last, more_efficient);
+
+			int64_t P = 0, W = 0;
+			for (size_t j = first; j < middle; ++j)
+			{
+				P += _items[j].value;
+				W += _items[j].weight;
+			}
+
+			if (weightsum + W > _capacity)
+				last = middle;
+			else if (weightsum + W + _items[middle].weight > _capacity)
+			{
+				valuesum += P;
+				weightsum += W;
+				return middle;
+			}
+			else
+			{
+				valuesum += P + _items[middle].value;
+				weightsum += W + _items[middle].weight;
+				first = middle + 1;
+			}
+		}
+		return first;
+	}
+
+
+	int64_t MT2::mt1(const std::vector<size_t>& items, int64_t capacity, int64_t lower_bound, std::vector<int>& solution)
+	{
+		// Depth-first branch-and-bound over 'items', which are sorted by efficiency. Returns the best value found
+		// that is higher than 'lower_bound' and stores the solution (x for every position in 'items'),
+		// otherwise returns 'lower_bound' and leaves 'solution' unchanged.
+		const size_t m = items.size();
+		std::vector<int64_t> prefix_value(m + 1, 0), prefix_weight(m + 1, 0);
+		for (size_t i = 0; i < m; ++i)
+		{
+			prefix_value[i + 1] = prefix_value[i] + _items[items[i]].value;
+			prefix_weight[i + 1] = prefix_weight[i] + _items[items[i]].weight;
+		}
+		auto value = [&](size_t i) -> int64_t { return _items[items[i]].value; };
+		auto weight = [&](size_t i) -> int64_t { return _items[items[i]].weight; };
+
+		// Upper bound U2 of Martello and Toth for the items [j, m) with residual capacity 'residual':
+		// the break item r is either left out (the rest is filled with the efficiency of item r+1)
+		// or added (capacity is made free with the efficiency of item r-1). If item r-1 has no weight, neither have
+		// the items before it, so no capacity can be made free; if item r+1 has no weight, it has no value either.
+		auto upper_bound_u2 = [&](size_t j, int64_t residual, int64_t profit) -> int64_t
+			{
+				size_t r = std::upper_bound(prefix_weight.begin() + j, prefix_weight.end(), prefix_weight[j] + residual)
+					- prefix_weight.begin() - 1;
+				if (r == m)
+					return profit + prefix_value[m] - prefix_value[j];
+
+				int64_t free = residual - (prefix_weight[r] - prefix_weight[j]);
+				int64_t P = profit + prefix_value[r] - prefix_value[j];
+				int64_t u0 = r + 1 < m && weight(r + 1) > 0 ? P + free * value(r + 1) / weight(r + 1) : P;
+				int64_t u1 = r > j && weight(r - 1) > 0 ? P + value(r) - ((weight(r) - free) * value(r - 1) + weight(r - 1) - 1) / weight(r - 1) : P;
+				return std::max(u0, u1);
+			};
+
+		struct Node
+		{
+			size_t j; // next item to branch on
+			int64_t residual;
+			int64_t profit;
+			int branch; // 0 = add item j next, 1 = leave item j out next, 2 = done
+		};
+		std::vector<Node> nodes;
+		std::vector<int> x(m, 0);
+		int64_t best_value = lower_bound;
+		nodes.push_back({ 0, capacity, 0, 0 });
+
+		while (!nodes.empty())
+		{
+			Node& node = nodes.back();
+			if (node.branch == 0)
+			{
+				++_nodes_explored;
+				if (node.profit > best_value)
+				{
+					best_value = node.profit;
+					solution.assign(x.begin(), x.begin() + node.j);
+					solution.resize(m, 0);
+					_output << "\nNew best solution found with z = " << best_value;
+				}
+
+				int64_t bound = node.j < m ? upper_bound_u2(node.j, node.residual, node.profit) : node.profit;
+				if (bound <= best_value)
+				{
+					nodes.pop_back();
+					continue;
+				}
+
+				// all remaining items fit: the bound is reached by adding them
+				if (prefix_weight[m] - prefix_weight[node.j] <= node.residual)
+				{
+					best_value = bound;
+					solution.assign(x.begin(), x.begin() + node.j);
+					solution.resize(m, 1);
+					_output << "\nNew best solution found with z = " << best_value;
+					nodes.pop_back();
+					continue;
+				}
+
+				node.branch = 1;
+				if (weight(node.j) <= node.residual)
+				{
+					Node child = { node.j + 1, node.residual - weight(node.j), node.profit + value(node.j), 0 };
+					x[node.j] = 1;
+					nodes.push_back(child);
+				}
+			}
+			else if (node.branch == 1)
+			{
+				node.branch = 2;
+				x[node.j] = 0;
+				if (upper_bound_u2(node.j + 1, node.residual, node.profit) > best_value)
+				{
+					Node child = { node.j + 1, node.residual, node.profit, 0 };
+					nodes.push_back(child);
+				}
+			}
+			else
+			{
+				nodes.pop_back();
+			}
+		}
+
+		return best_value;
+	}
+
+
+	void MT2::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nStarting the branch-and-bound algorithm MT2 of Martello and Toth ...";
+		_output.set_on(verbose);
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize
+		const size_t n = _items.size();
+		_best_solution.assign(n, 0);
+		_nodes_explored = 0;
+
+
+
+		// 1. find the critical item without sorting all items
+		_output << "\n\nFinding the critical item ...";
+		int64_t valuesum = 0, weightsum = 0;
+		size_t breakitem_index = find_critical_item(valuesum, weightsum);
+		_output << "\nCritical item = " << breakitem_index + 1 << ", Pb = " << valuesum << ", Wb = " << weightsum;
+		if (breakitem_index == n)
+		{
+			_best_value = valuesum;
+			_best_solution.assign(n, 1);
+		}
+
+
+
+		// 2. approximate core: the items around the critical item, sorted by efficiency
+		size_t core_size = std::min(n, std::max<size_t>(100, static_cast<size_t>(2 * std::sqrt(static_cast<double>(n)))));
+		size_t first = breakitem_index > core_size / 2 ? breakitem_index - core_size / 2 : 0;
+		size_t last = std::min(n, first + core_size);
+		first = last - std::min(last, core_size);
+		if (breakitem_index < n)
+		{
+			std::nth_element(_items.begin(), _items.begin() + first, _items.begin() + breakitem_index, more_efficient);
+			if (last > breakitem_index + 1)
+				std::nth_element(_items.begin() + breakitem_index + 1, _items.begin() + last - 1, _items.end(), more_efficient);
+			std::sort(_items.begin() + first, _items.begin() + last, more_efficient);
+			_output << "\nCore = [" << first + 1 << ", " << last << "]";
+
+			// the items before the core are in the knapsack
+			int64_t fixed_value = 0, fixed_weight = 0;
+			for (size_t j = 0; j < first; ++j)
+			{
+				fixed_value += _items[j].value;
+				fixed_weight += _items[j].weight;
+			}
+
+			std::vector<size_t> core;
+			for (size_t j = first; j < last; ++j)
+				core.push_back(j);
+			std::vector<int> solution;
+			_best_value = fixed_value + mt1(core, _capacity - fixed_weight, -1, solution);
+			for (size_t j = 0; j < first; ++j)
+				_best_solution[j] = 1;
+			for (size_t i = 0; i < core.size(); ++i)
+				_best_solution[core[i]] = solution[i];
+			_output << "\nSolution of the core problem: z = " << _best_value;
+		}
+
+
+
+		// 3. reduction: fix the items outside the core for which the opposite value cannot lead to a better solution.
+		// All items outside [0, b] have an efficiency of at most the efficiency of the critical item b, all items in
+		// [0, b) at least, so changing x[j] gives at most Pb - p[j] + (C - Wb + w[j]) p[b] / w[b] for j < b
+		// and Pb + p[j] + (C - Wb - w[j]) p[b] / w[b] for j > b.
+		if (breakitem_index < n)
+		{
+			const int64_t pb = _items[breakitem_index].value;
+			const int64_t wb = _items[breakitem_index].weight; // > 0, because the critical item doesn't fit
+			auto floor_div = [](int64_t a, int64_t b) { return a >= 0 ? a / b : -((-a + b - 1) / b); };
+
+			std::vector<size_t> free_items;
+			int64_t fixed_value = 0, fixed_weight = 0;
+			size_t nb_fixed = 0;
+			for (size_t j = 0; j < n; ++j)
+			{
+				if (j >= first && j < last)
+				{
+					free_items.push_back(j);
+					continue;
+				}
+
+				int64_t bound = j < breakitem_index
+					? valuesum - _items[j].value + floor_div((_capacity - weightsum + _items[j].weight) * pb, wb)
+					: valuesum + _items[j].value + floor_div((_capacity - weightsum - _items[j].weight) * pb, wb);
+
+				if (bound <= _best_value)
+				{
+					++nb_fixed;
+					if (j < breakitem_index)
+					{
+						fixed_value += _items[j].value;
+						fixed_weight += _items[j].weight;
+					}
+				}
+				else
+					free_items.push_back(j);
+			}
+			_output << "\n\nReduction: " << nb_fixed << " of the " << n - (last - first) << " items outside the core are fixed";
+
+
+
+			// 4. if not all items outside the core are fixed, solve the reduced problem with MT1
+			if (free_items.size() > last - first)
+			{
+				std::sort(free_items.begin(), free_items.end(), [this](size_t a, size_t b) { return more_efficient(_items[a], _items[b]); });
+				_output << "\nSolving the reduced problem with " << free_items.size() << " items ...";
+
+				std::vector<int> solution;
+				int64_t value = mt1(free_items, _capacity - fixed_weight, _best_value - fixed_value, solution);
+				if (fixed_value + value > _best_value)
+				{
+					_best_value = fixed_value + value;
+					_best_solution.assign(n, 0);
+					for (size_t j = 0; j < first; ++j)
+						_best_solution[j] = 1; // fixed items, the free ones are overwritten below
+					for (size_t i = 0; i < free_items.size(); ++i)
+						_best_solution[free_items[i]] = solution[i];
+				}
+			}
+		}
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nNodes explored: " << _nodes_explored
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in MT2: Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in MT2: Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+}
\ No newline at end of file
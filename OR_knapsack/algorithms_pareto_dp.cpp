@@ -0,0 +1,139 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+
+
+namespace KP
+{
+	void ParetoDP::merge(size_t j)
+	{
+		// Merge the states with the states in which item j is added and that fit in the knapsack
+		merge_states(_states, static_cast<int>(j), _items[j].value, _items[j].weight, _capacity, _trail, _buffer);
+		_states.swap(_buffer);
+	}
+
+
+	void ParetoDP::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nDynamic programming of Nemhauser and Ullmann with the undominated states only ...";
+		_output.set_on(verbose);
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize
+		_best_solution.assign(_items.size(), 0);
+		_trail.clear();
+		_states.clear();
+		_buffer.clear();
+		_states.push_back({ 0, 0, -1 });
+		_best_value = 0;
+		int best_trail = -1;
+		size_t max_states = 1;
+
+
+
+		// 1. sort items based on efficiency (highest to lowest), so that the bound test below removes
+		// most states early; the dominance test itself does not depend on the order of the items
+		_output << "\n\nSorting the items from most efficient to least efficient";
+		sort_by_efficiency();
+		const size_t n = _items.size();
+
+
+
+		// 2. greedy heuristic as the first lower bound
+		{
+			int64_t W = 0;
+			for (size_t j = 0; j < n; ++j)
+			{
+				if (W + _items[j].weight <= _capacity)
+				{
+					_best_value += _items[j].value;
+					W += _items[j].weight;
+					best_trail = _trail.add(static_cast<int>(j), best_trail);
+				}
+			}
+			_output << "\nGreedy solution: z = " << _best_value;
+		}
+
+
+
+		// 3. one stage for every item
+		for (size_t j = 0; j < n && !_states.empty(); ++j)
+		{
+			merge(j);
+
+			// all states are feasible, and the heaviest one has the highest profit
+			if (_states.back().profit > _best_value)
+			{
+				_best_value = _states.back().profit;
+				best_trail = _states.back().trail;
+			}
+
+			// remove the states that cannot lead to a better solution with the items j' > j (bound of Dantzig)
+			size_t nb_kept = 0;
+			for (auto&& state : _states)
+			{
+				if (j + 1 < n && (state.profit - _best_value - 1) * _items[j + 1].weight
+					+ (_capacity - state.weight) * _items[j + 1].value >= 0)
+					_states[nb_kept++] = state;
+			}
+			_states.resize(nb_kept);
+
+			max_states = std::max(max_states, _states.size());
+			_output << "\nItem " << j + 1 << ": undominated states = " << _states.size() << ", z = " << _best_value;
+
+			if (_trail.needs_compaction())
+				_trail.compact(_states, best_trail);
+		}
+
+
+
+		// 4. store optimal solution
+		_trail.apply(best_trail, _best_solution);
+		_states.clear();
+		_buffer.clear();
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nMaximum number of states: " << max_states
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in ParetoDP: Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in ParetoDP: Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+}
\ No newline at end of file
@@ -1,95 +1,343 @@
 #include "algorithms.h"
 #include <chrono>
 #include <stdexcept>
+#include <thread>
+#include <cstdlib>
 
 
 namespace KP
 {
 
-	bool PisingerBB::branching(int64_t P, int64_t W, int64_t s, int64_t t)
+	void PisingerBB::improve(Search& search, int64_t value)
 	{
-		++_nodes_explored;
-		bool improved = false;
+		// path to the node on top of the stack
+		search.position = search.path;
+		for (size_t d = 0; d + 1 < search.frames.size(); ++d)
+			search.position.push_back(static_cast<int>(search.frames[d].item));
+		search.best_value = std::max(search.best_value, value);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (value > _incumbent || (value == _incumbent && search.position < _incumbent_path))
+		{
+			_incumbent = value;
+			_incumbent_path = search.position;
+			++_incumbent_version;
 
-		_output << "\n\nP = " << P << ", W = " << W << ", s = " << s + 1 << ", t = " << t + 1;
+			_output << "\nNew best solution found!";
+		}
+	}
 
-		if (W <= _capacity) // add some item j >= t
-		{
-			if (P > _best_value)
+	void PisingerBB::update_lower_bound(Search& search)
+	{
+		// Solutions with the value of the incumbent are pruned if the incumbent comes first in the depth-first search.
+		// The current node is used for the subtree of the node on top of the stack, which is only more careful.
+		search.position = search.path;
+		for (size_t d = 0; d + 1 < search.frames.size(); ++d)
+			search.position.push_back(static_cast<int>(search.frames[d].item));
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		search.incumbent_version = _incumbent_version;
+		bool incumbent_first = !(search.position < _incumbent_path);
+		search.lower_bound = std::max(search.best_value, incumbent_first ? _incumbent.load() : _incumbent.load() - 1);
+	}
+
+	void PisingerBB::branching(Search& search, int64_t P, int64_t W, int64_t s, int64_t t, size_t split_depth)
+	{
+		// Depth-first search with an explicit stack of frames, so that the depth is not limited by the call stack.
+		// The items changed on the path to a node are the items of the frames above it.
+		std::vector<Frame>& frames = search.frames;
+		frames.clear();
+		frames.push_back({ P, W, s, t, -1 });
+		update_lower_bound(search);
+
+		// evaluate the node on top of the stack
+		auto enter = [this, &search, &frames]()
 			{
-				improved = true;
-				_best_value = P;
-				_exceptions.clear();
+				const Frame& node = frames.back();
+				++search.nodes_explored;
+				_output << "\n\nP = " << node.P << ", W = " << node.W << ", s = " << node.s + 1 << ", t = " << node.t + 1;
 
-				_output << "\nNew best solution found!";
-			}
+				if (node.W <= _capacity && node.P > search.lower_bound)
+				{
+					improve(search, node.P);
+					update_lower_bound(search);
+				}
+			};
 
-			while (true)
+		// the child of the node on top of the stack is explored, or stored as a subproblem at the split depth
+		auto branch = [this, &search, &frames, split_depth, &enter](const Frame& child)
+			{
+				if (frames.size() == split_depth)
+				{
+					Subproblem subproblem = { child, search.path };
+					for (auto&& frame : frames)
+						subproblem.path.push_back(static_cast<int>(frame.item));
+
+					std::unique_lock<std::mutex> lock(_mutex);
+					_queue_changed.wait(lock, [this] { return _queue.size() < _queue_limit; });
+					_queue.push_back(std::move(subproblem));
+					_queue_changed.notify_all();
+					return;
+				}
+				frames.push_back(child);
+				enter();
+			};
+		enter();
+
+		while (!frames.empty())
+		{
+			if (_incumbent_version.load(std::memory_order_relaxed) != search.incumbent_version)
+				update_lower_bound(search);
+			const int64_t lower_bound = search.lower_bound;
+			Frame& node = frames.back();
+
+			if (node.W <= _capacity) // add some item j >= t
 			{
 				// limits
-				if (t >= _items.size())
+				if (node.t >= static_cast<int64_t>(_items.size()))
 				{
 					_output << "\nCannot add any more items: Backtrack ...\n";
-					return improved;
+					frames.pop_back();
+					continue;
 				}
 
+				if (_expanding_core)
+					expand_core(node.t);
+
 				// upper bound test
-				double UB = P + (_capacity - W) * (double)_items[t].value / (double)_items[t].weight;
-				_output << "\nDo upper bound test: P + (C-W) ps/ws = " << P << " + (" << _capacity << "-"
-					<< W << ")*" << _items[t].value << "/" << _items[t].weight << " = " << UB;
+				const Item& item = _items[node.t];
+				double UB = node.P + (_capacity - node.W) * (double)item.value / (double)item.weight;
+				_output << "\nDo upper bound test: P + (C-W) ps/ws = " << node.P << " + (" << _capacity << "-"
+					<< node.W << ")*" << item.value << "/" << item.weight << " = " << UB;
 
-				if (det(P - _best_value - 1, W - _capacity, _items[t].value, _items[t].weight) < 0)
+				if (det(node.P - lower_bound - 1, node.W - _capacity, item.value, item.weight) < 0)
 				{
 					_output << "\nUB <= current best solution. Backtrack ...\n";
-					return improved;
+					frames.pop_back();
+					continue;
 				}
 
-				// branch one level further
-				_output << "\nTry to add item " << t + 1;
-				if (branching(P + _items[t].value, W + _items[t].weight, s, t + 1))
+				// tighter bound: LP relaxation of all items j >= t
+				if (!_expanding_core && node.P + _lp_bound.add_bound(node.t, _capacity - node.W) <= lower_bound)
 				{
-					improved = true;
-					_exceptions.push_back(t);
+					_output << "\nLP bound of the items j >= t <= current best solution. Backtrack ...\n";
+					frames.pop_back();
+					continue;
 				}
 
-				// go to next item
-				++t;
+				// branch one level further, afterwards go to next item
+				_output << "\nTry to add item " << node.t + 1;
+				node.item = node.t++;
+				Frame child = { node.P + item.value, node.W + item.weight, node.s, node.t, -1 };
+				branch(child);
 			}
-		}
-		else // remove some item j <= s
-		{
-			while (true)
+			else // remove some item j <= s
 			{
 				// limits
-				if (s < 0)
+				if (node.s < 0)
 				{
 					_output << "\nCannot remove any more items: Backtrack ...\n";
-					return improved;
+					frames.pop_back();
+					continue;
 				}
 
+				if (_expanding_core)
+					expand_core(node.s);
+
 				// upper bound test
-				double UB = P + (_capacity - W) * (double)_items[s].value / (double)_items[s].weight;
-				_output << "\nDo upper bound test: P + (C-W) ps/ws = " << P << " + (" << _capacity << "-"
-					<< W << ")*" << _items[s].value << "/" << _items[s].weight << " = " << UB;
+				const Item& item = _items[node.s];
+				double UB = node.P + (_capacity - node.W) * (double)item.value / (double)item.weight;
+				_output << "\nDo upper bound test: P + (C-W) ps/ws = " << node.P << " + (" << _capacity << "-"
+					<< node.W << ")*" << item.value << "/" << item.weight << " = " << UB;
 
-				if (det(P - _best_value - 1, W - _capacity, _items[s].value, _items[s].weight) < 0)
+				if (det(node.P - lower_bound - 1, node.W - _capacity, item.value, item.weight) < 0)
 				{
 					_output << "\nUB <= current best solution. Backtrack ...\n";
-					return improved;
+					frames.pop_back();
+					continue;
 				}
 
-				// branch one level further
-				_output << "\nTry to remove item " << s + 1;
-				if (branching(P - _items[s].value, W - _items[s].weight, s - 1, t))
+				// tighter bound: LP relaxation of removing items j <= s
+				if (!_expanding_core)
 				{
-					improved = true;
-					_exceptions.push_back(s);
+					int64_t lost = _lp_bound.remove_bound(node.s + 1, node.W - _capacity);
+					if (lost < 0 || node.P - lost <= lower_bound)
+					{
+						_output << "\nLP bound of the items j <= s <= current best solution. Backtrack ...\n";
+						frames.pop_back();
+						continue;
+					}
 				}
 
-				// go to previous item
-				--s;
+				// branch one level further, afterwards go to previous item
+				_output << "\nTry to remove item " << node.s + 1;
+				node.item = -node.s--;
+				Frame child = { node.P - item.value, node.W - item.weight, node.s, node.t, -1 };
+				branch(child);
 			}
 		}
+
+	}
+
+	void PisingerBB::parallel_branching(int64_t P, int64_t W, int64_t s, int64_t t, size_t nb_threads)
+	{
+		// The nodes above the split depth are explored by this thread, the nodes at the split depth are subproblems
+		// for the other threads (at least one). When all subproblems are created, this thread explores subproblems
+		// as well. The threads don't write to the output.
+		_output << "\n\nExploring the subproblems at depth " << _split_depth << " with " << nb_threads << " threads";
+		bool on = _output.is_on();
+		_output.set_on(false);
+
+		_queue.clear();
+		_queue_limit = 2 * nb_threads;
+		_splitting = true;
+
+		auto work = [this]()
+			{
+				Search search;
+				while (true)
+				{
+					Subproblem subproblem;
+					{
+						std::unique_lock<std::mutex> lock(_mutex);
+						_queue_changed.wait(lock, [this] { return !_queue.empty() || !_splitting; });
+						if (_queue.empty())
+						{
+							_search.nodes_explored += search.nodes_explored;
+							return;
+						}
+						subproblem = std::move(_queue.front());
+						_queue.pop_front();
+						_queue_changed.notify_all();
+					}
+
+					search.path.swap(subproblem.path);
+					search.best_value = std::numeric_limits<int64_t>::min();
+					branching(search, subproblem.root.P, subproblem.root.W, subproblem.root.s, subproblem.root.t, 0);
+				}
+			};
+		std::vector<std::thread> threads;
+		for (size_t i = 1; i < nb_threads; ++i)
+			threads.emplace_back(work);
+
+		branching(_search, P, W, s, t, _split_depth);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_splitting = false;
+			_queue_changed.notify_all();
+		}
+		work();
+		for (auto&& thread : threads)
+			thread.join();
+
+		_output.set_on(on);
+	}
+
+	size_t PisingerBB::partial_sort(int64_t& valuesum, int64_t& weightsum)
+	{
+		// As in expknap, partition the items around the efficiency of a pivot until the interval
+		// containing the break item is small. The intervals on both sides are ordered with respect
+		// to each other, but are only sorted internally when the branching reaches them.
+		const size_t min_core_size = 32;
+		auto more_efficient = [](const Item& a, const Item& b)
+			{ return static_cast<int64_t>(a.value) * b.weight > static_cast<int64_t>(a.weight) * b.value; };
+
+		_left_intervals.clear();
+		_right_intervals.clear();
+		valuesum = 0;
+		weightsum = 0;
+
+		size_t first = 0, last = _items.size();
+		while (last - first > min_core_size)
+		{
+			// pivot = median of three
+			Item a = _items[first], b = _items[first + (last - first) / 2], c = _items[last - 1];
+			if (more_efficient(b, a))
+				std::swap(a, b);
+			if (more_efficient(c, b))
+				std::swap(b, c);
+			if (more_efficient(b, a))
+				std::swap(a, b);
+			Item pivot = b;
+
+			// [first, mid1) more efficient than the pivot, [mid1, mid2) equally efficient, [mid2, last) less efficient
+			size_t mid1 = std::partition(_items.begin() + first, _items.begin() + last,
+				[&](const Item& i) { return more_efficient(i, pivot); }) - _items.begin();
+			size_t mid2 = std::partition(_items.begin() + mid1, _items.begin() + last,
+				[&](const Item& i) { return !more_efficient(pivot, i); }) - _items.begin();
+
+			int64_t P1 = 0, W1 = 0;
+			for (size_t i = first; i < mid1; ++i)
+			{
+				P1 += _items[i].value;
+				W1 += _items[i].weight;
+			}
+			if (weightsum + W1 > _capacity)
+			{
+				_right_intervals.push_back({ mid1, last });
+				last = mid1;
+				continue;
+			}
+
+			int64_t P2 = 0, W2 = 0;
+			for (size_t i = mid1; i < mid2; ++i)
+			{
+				P2 += _items[i].value;
+				W2 += _items[i].weight;
+			}
+			if (weightsum + W1 + W2 > _capacity) // break item is as efficient as the pivot
+			{
+				if (first < mid1)
+					_left_intervals.push_back({ first, mid1 });
+				if (mid2 < last)
+					_right_intervals.push_back({ mid2, last });
+				valuesum += P1;
+				weightsum += W1;
+				first = mid1;
+				last = mid2;
+				break;
+			}
+
+			_left_intervals.push_back({ first, mid2 });
+			valuesum += P1 + P2;
+			weightsum += W1 + W2;
+			first = mid2;
+		}
+
+		sort_by_efficiency(first, last);
+		_core_first = first;
+		_core_last = last;
+
+		size_t breakitem_index = first;
+		while (breakitem_index < last && weightsum + _items[breakitem_index].weight <= _capacity)
+		{
+			valuesum += _items[breakitem_index].value;
+			weightsum += _items[breakitem_index].weight;
+			++breakitem_index;
+		}
+		return breakitem_index;
+	}
+
+	void PisingerBB::expand_core(int64_t j)
+	{
+		while (j >= static_cast<int64_t>(_core_last) && !_right_intervals.empty())
+		{
+			Interval interval = _right_intervals.back();
+			_right_intervals.pop_back();
+			sort_by_efficiency(interval.first, interval.last);
+			_core_last = interval.last;
+
+			_output << "\nSorting items " << interval.first + 1 << " to " << interval.last;
+		}
+		while (j < static_cast<int64_t>(_core_first) && !_left_intervals.empty())
+		{
+			Interval interval = _left_intervals.back();
+			_left_intervals.pop_back();
+			sort_by_efficiency(interval.first, interval.last);
+			_core_first = interval.first;
+
+			_output << "\nSorting items " << interval.first + 1 << " to " << interval.last;
+		}
 	}
 
 	void PisingerBB::run(bool verbose)
@@ -109,38 +357,34 @@ namespace KP
 			_best_solution.push_back(0);
 		_best_value = 0;
 		_exceptions.clear();
-		_nodes_explored = 0;
+		_search.nodes_explored = 0;
 
 
 
 		// 1. sort items based on efficiency (highest to lowest)
-		_output << "\n\nSorting the items from most efficient to least efficient";
-		std::sort(_items.begin(), _items.end(), [](const Item& a, const Item& b)
-			{
-				if (a.value * b.weight > a.weight * b.value)
-					return true;
-				return false;
-			}
-		);
+		int64_t valuesum = 0, weightsum = 0;
+		size_t breakitem_index = 0;
+		if (_expanding_core)
+		{
+			_output << "\n\nPartitioning the items around the break item, only the core is sorted";
+			breakitem_index = partial_sort(valuesum, weightsum);
+			_output << "\nSorted core = items " << _core_first + 1 << " to " << _core_last;
+		}
+		else
+		{
+			_output << "\n\nSorting the items from most efficient to least efficient";
+			sort_by_efficiency();
+			_lp_bound.build(_items);
+		}
 
 
 
 		// 2. find the break item and store x vector
 		_output << "\n\nFinding the break item ...";
-		size_t breakitem_index = 0;
-		size_t weightsum = 0, valuesum = 0;
-		for (size_t i = 0; i < _items.size(); ++i)
-		{
-			weightsum += _items[i].weight;
-			if (weightsum > _capacity)
-			{
-				breakitem_index = i;
-				weightsum -= _items[i].weight;
-				break;
-			}
-			valuesum += _items[i].value;
+		if (!_expanding_core)
+			breakitem_index = find_break_item(valuesum, weightsum);
+		for (size_t i = 0; i < breakitem_index; ++i)
 			_best_solution[i] = 1;
-		}
 		_best_value = valuesum;
 		_output << "\nBreakitem = " << breakitem_index + 1 << ", Pb = " << valuesum << ", Ws = " << weightsum;
 
@@ -166,7 +410,7 @@ namespace KP
 			}
 		}
 		// backward greedy
-		for (size_t i = 0; i < breakitem_index; ++i)
+		for (size_t i = 0; i < breakitem_index && breakitem_index < _items.size(); ++i)
 		{
 			if (weightsum + _items[breakitem_index].weight - _items[i].weight <= _capacity)
 			{
@@ -184,9 +428,41 @@ namespace KP
 		}
 
 
+		// the items of the heuristic solution may still move when their interval is sorted
+		std::vector<int> heuristic_items;
+		for (auto&& e : _exceptions)
+			heuristic_items.push_back(_items[e].number);
+
+
+
 		// 4. branching
 		_output << "\n\nStart branching procedure ...";
-		branching(valuesum, weightsum, breakitem_index - 1, breakitem_index);
+		_search.path.clear();
+		_search.best_value = _best_value;
+		_incumbent = _best_value;
+		_incumbent_path.clear();
+		_incumbent_version = 0;
+		const size_t nb_threads = _threads > 0 ? _threads : std::max<size_t>(1, std::thread::hardware_concurrency());
+		if (nb_threads > 1 && !_expanding_core)
+			parallel_branching(valuesum, weightsum, breakitem_index - 1, breakitem_index, nb_threads);
+		else
+			branching(_search, valuesum, weightsum, breakitem_index - 1, breakitem_index, 0);
+
+		bool improved = _incumbent > _best_value;
+		if (improved)
+		{
+			_best_value = _incumbent;
+			_exceptions.clear();
+			for (auto&& item : _incumbent_path)
+				_exceptions.push_back(std::abs(item));
+		}
+		if (_expanding_core && !improved)
+		{
+			_exceptions.clear();
+			for (size_t i = 0; i < _items.size(); ++i)
+				if (std::find(heuristic_items.begin(), heuristic_items.end(), _items[i].number) != heuristic_items.end())
+					_exceptions.push_back(i);
+		}
 
 
 		// 5. store optimal solution
@@ -199,7 +475,7 @@ namespace KP
 		elapsed_time = std::chrono::system_clock::now() - start_time;
 		_output.set_on(true);
 		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
-			<< "\nNodes explored: " << _nodes_explored
+			<< "\nNodes explored: " << _search.nodes_explored
 			<< "\nOptimal solution: z = " << _best_value << "\n";
 		if (_items.size() <= 10) {
 			for (size_t i = 0; i < _items.size(); ++i) {
@@ -0,0 +1,400 @@
+#include "algorithms.h"
+#include <stdexcept>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define KP_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define KP_TARGET(isa)
+#else
+#include <immintrin.h>
+#include <cpuid.h>
+#define KP_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+
+
+namespace KP
+{
+	namespace
+	{
+		// c = last .. first, from high to low so that profits[c - w] still belongs to the previous item
+		void add_item_scalar(int64_t* profits, int64_t first, int64_t last, int64_t weight, int64_t value, uint64_t* take)
+		{
+			for (int64_t c = last; c >= first; --c)
+			{
+				if (profits[c - weight] + value > profits[c])
+				{
+					profits[c] = profits[c - weight] + value;
+					if (take)
+						take[c / 64] |= uint64_t(1) << (c % 64);
+				}
+			}
+		}
+
+
+		// profits[c - w_a - w_b] is only used if both items fit
+		void add_items_scalar(int64_t* profits, int64_t first, int64_t last, const Item& a, const Item& b)
+		{
+			for (int64_t c = last; c >= first; --c)
+			{
+				int64_t best = profits[c];
+				if (c >= a.weight)
+					best = std::max<int64_t>(best, profits[c - a.weight] + a.value);
+				if (c >= b.weight)
+					best = std::max<int64_t>(best, profits[c - b.weight] + b.value);
+				if (c >= a.weight + b.weight)
+					best = std::max<int64_t>(best, profits[c - a.weight - b.weight] + a.value + b.value);
+				profits[c] = best;
+			}
+		}
+
+
+		// words i = last - 1 .. first of bits |= bits << (64 q + r), from high to low so that it can be done in place:
+		// word i receives the words i - q (shifted left by r bits) and i - q - 1 (shifted right by 64 - r bits)
+		void shift_or_scalar(uint64_t* bits, size_t first, size_t last, size_t q, unsigned r, uint64_t* new_bits)
+		{
+			for (size_t i = last; i-- > first; )
+			{
+				uint64_t shifted = bits[i - q] << r;
+				if (r != 0 && i > q)
+					shifted |= bits[i - q - 1] >> (64 - r);
+				if (new_bits)
+					new_bits[i] = shifted & ~bits[i];
+				bits[i] |= shifted;
+			}
+		}
+
+
+#if defined(KP_X86)
+		// Blocks of profits [c - width, c) from high to low c. All profits of a block are loaded before it is stored,
+		// so the profits [c - width - w, c - w) are still those of the previous item, even if w < width.
+		// The blocks start at a multiple of the width, so that the bits of a block are in the same word of 'take'.
+
+		KP_TARGET("sse4.2") void add_item_sse4(int64_t* profits, int64_t capacity, int64_t weight, int64_t value, uint64_t* take)
+		{
+			int64_t c = std::max(weight, (capacity + 1) / 2 * 2);
+			add_item_scalar(profits, c, capacity, weight, value, take);
+
+			const __m128i values = _mm_set1_epi64x(value);
+			for (; c - 2 >= weight; c -= 2)
+			{
+				__m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(profits + c - 2));
+				__m128i added = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(profits + c - 2 - weight)), values);
+				__m128i better = _mm_cmpgt_epi64(added, old);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(profits + c - 2), _mm_blendv_epi8(old, added, better));
+				if (take)
+					take[(c - 2) / 64] |= uint64_t(_mm_movemask_pd(_mm_castsi128_pd(better))) << ((c - 2) % 64);
+			}
+
+			add_item_scalar(profits, weight, c - 1, weight, value, take);
+		}
+
+
+		KP_TARGET("avx2") void add_item_avx2(int64_t* profits, int64_t capacity, int64_t weight, int64_t value, uint64_t* take)
+		{
+			int64_t c = std::max(weight, (capacity + 1) / 4 * 4);
+			add_item_scalar(profits, c, capacity, weight, value, take);
+
+			const __m256i values = _mm256_set1_epi64x(value);
+			for (; c - 4 >= weight; c -= 4)
+			{
+				__m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(profits + c - 4));
+				__m256i added = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(profits + c - 4 - weight)), values);
+				__m256i better = _mm256_cmpgt_epi64(added, old);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(profits + c - 4), _mm256_blendv_epi8(old, added, better));
+				if (take)
+					take[(c - 4) / 64] |= uint64_t(_mm256_movemask_pd(_mm256_castsi256_pd(better))) << ((c - 4) % 64);
+			}
+
+			add_item_scalar(profits, weight, c - 1, weight, value, take);
+		}
+
+
+		KP_TARGET("avx512f") void add_item_avx512(int64_t* profits, int64_t capacity, int64_t weight, int64_t value, uint64_t* take)
+		{
+			int64_t c = std::max(weight, (capacity + 1) / 8 * 8);
+			add_item_scalar(profits, c, capacity, weight, value, take);
+
+			const __m512i values = _mm512_set1_epi64(value);
+			for (; c - 8 >= weight; c -= 8)
+			{
+				__m512i old = _mm512_loadu_si512(profits + c - 8);
+				__m512i added = _mm512_add_epi64(_mm512_loadu_si512(profits + c - 8 - weight), values);
+				__mmask8 better = _mm512_cmpgt_epi64_mask(added, old);
+				_mm512_storeu_si512(profits + c - 8, _mm512_mask_mov_epi64(old, better, added));
+				if (take)
+					take[(c - 8) / 64] |= uint64_t(better) << ((c - 8) % 64);
+			}
+
+			add_item_scalar(profits, weight, c - 1, weight, value, take);
+		}
+
+
+		// Two items: the blocks [c - width, c) with c - width >= w_a + w_b, the rest is scalar
+
+		KP_TARGET("sse4.2") void add_items_sse4(int64_t* profits, int64_t capacity, const Item& a, const Item& b)
+		{
+			const __m128i value_a = _mm_set1_epi64x(a.value), value_b = _mm_set1_epi64x(b.value), value_ab = _mm_set1_epi64x(int64_t(a.value) + b.value);
+			int64_t c = capacity + 1;
+			for (; c - 2 >= a.weight + b.weight; c -= 2)
+			{
+				int64_t* block = profits + c - 2;
+				__m128i best = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+				__m128i added = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block - a.weight)), value_a);
+				best = _mm_blendv_epi8(best, added, _mm_cmpgt_epi64(added, best));
+				added = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block - b.weight)), value_b);
+				best = _mm_blendv_epi8(best, added, _mm_cmpgt_epi64(added, best));
+				added = _mm_add_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block - a.weight - b.weight)), value_ab);
+				best = _mm_blendv_epi8(best, added, _mm_cmpgt_epi64(added, best));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(block), best);
+			}
+			add_items_scalar(profits, std::min(a.weight, b.weight), c - 1, a, b);
+		}
+
+
+		KP_TARGET("avx2") void add_items_avx2(int64_t* profits, int64_t capacity, const Item& a, const Item& b)
+		{
+			const __m256i value_a = _mm256_set1_epi64x(a.value), value_b = _mm256_set1_epi64x(b.value), value_ab = _mm256_set1_epi64x(int64_t(a.value) + b.value);
+			int64_t c = capacity + 1;
+			for (; c - 4 >= a.weight + b.weight; c -= 4)
+			{
+				int64_t* block = profits + c - 4;
+				__m256i best = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+				__m256i added = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block - a.weight)), value_a);
+				best = _mm256_blendv_epi8(best, added, _mm256_cmpgt_epi64(added, best));
+				added = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block - b.weight)), value_b);
+				best = _mm256_blendv_epi8(best, added, _mm256_cmpgt_epi64(added, best));
+				added = _mm256_add_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block - a.weight - b.weight)), value_ab);
+				best = _mm256_blendv_epi8(best, added, _mm256_cmpgt_epi64(added, best));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(block), best);
+			}
+			add_items_scalar(profits, std::min(a.weight, b.weight), c - 1, a, b);
+		}
+
+
+		KP_TARGET("avx512f") void add_items_avx512(int64_t* profits, int64_t capacity, const Item& a, const Item& b)
+		{
+			const __m512i value_a = _mm512_set1_epi64(a.value), value_b = _mm512_set1_epi64(b.value), value_ab = _mm512_set1_epi64(int64_t(a.value) + b.value);
+			int64_t c = capacity + 1;
+			for (; c - 8 >= a.weight + b.weight; c -= 8)
+			{
+				int64_t* block = profits + c - 8;
+				__m512i best = _mm512_loadu_si512(block);
+				best = _mm512_max_epi64(best, _mm512_add_epi64(_mm512_loadu_si512(block - a.weight), value_a));
+				best = _mm512_max_epi64(best, _mm512_add_epi64(_mm512_loadu_si512(block - b.weight), value_b));
+				best = _mm512_max_epi64(best, _mm512_add_epi64(_mm512_loadu_si512(block - a.weight - b.weight), value_ab));
+				_mm512_storeu_si512(block, best);
+			}
+			add_items_scalar(profits, std::min(a.weight, b.weight), c - 1, a, b);
+		}
+
+
+		// Blocks of words [i - width, i) with i - width - 1 >= q. A shift of 64 bits or more gives 0, so r = 0 needs no
+		// special case.
+
+		KP_TARGET("sse4.2") void shift_or_sse4(uint64_t* bits, size_t nb_words, size_t q, unsigned r, uint64_t* new_bits)
+		{
+			const __m128i left = _mm_cvtsi32_si128(r), right = _mm_cvtsi32_si128(64 - r);
+			size_t i = nb_words;
+			for (; i >= q + 3; i -= 2)
+			{
+				__m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + i - 2 - q));
+				__m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + i - 3 - q));
+				__m128i shifted = _mm_or_si128(_mm_sll_epi64(high, left), _mm_srl_epi64(low, right));
+				__m128i old = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bits + i - 2));
+				if (new_bits)
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(new_bits + i - 2), _mm_andnot_si128(old, shifted));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(bits + i - 2), _mm_or_si128(old, shifted));
+			}
+			shift_or_scalar(bits, q, i, q, r, new_bits);
+		}
+
+
+		KP_TARGET("avx2") void shift_or_avx2(uint64_t* bits, size_t nb_words, size_t q, unsigned r, uint64_t* new_bits)
+		{
+			const __m128i left = _mm_cvtsi32_si128(r), right = _mm_cvtsi32_si128(64 - r);
+			size_t i = nb_words;
+			for (; i >= q + 5; i -= 4)
+			{
+				__m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + i - 4 - q));
+				__m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + i - 5 - q));
+				__m256i shifted = _mm256_or_si256(_mm256_sll_epi64(high, left), _mm256_srl_epi64(low, right));
+				__m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bits + i - 4));
+				if (new_bits)
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(new_bits + i - 4), _mm256_andnot_si256(old, shifted));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(bits + i - 4), _mm256_or_si256(old, shifted));
+			}
+			shift_or_scalar(bits, q, i, q, r, new_bits);
+		}
+
+
+		KP_TARGET("avx512f") void shift_or_avx512(uint64_t* bits, size_t nb_words, size_t q, unsigned r, uint64_t* new_bits)
+		{
+			const __m128i left = _mm_cvtsi32_si128(r), right = _mm_cvtsi32_si128(64 - r);
+			size_t i = nb_words;
+			for (; i >= q + 9; i -= 8)
+			{
+				__m512i high = _mm512_loadu_si512(bits + i - 8 - q);
+				__m512i low = _mm512_loadu_si512(bits + i - 9 - q);
+				__m512i shifted = _mm512_or_si512(_mm512_sll_epi64(high, left), _mm512_srl_epi64(low, right));
+				__m512i old = _mm512_loadu_si512(bits + i - 8);
+				if (new_bits)
+					_mm512_storeu_si512(new_bits + i - 8, _mm512_andnot_si512(old, shifted));
+				_mm512_storeu_si512(bits + i - 8, _mm512_or_si512(old, shifted));
+			}
+			shift_or_scalar(bits, q, i, q, r, new_bits);
+		}
+
+
+		void cpuid(int leaf, int info[4])
+		{
+#if defined(_MSC_VER)
+			__cpuidex(info, leaf, 0);
+#else
+			unsigned int a, b, c, d;
+			__cpuid_count(leaf, 0, a, b, c, d);
+			info[0] = a; info[1] = b; info[2] = c; info[3] = d;
+#endif
+		}
+
+
+		// Registers whose state is saved by the operating system (XCR0)
+		uint64_t saved_registers()
+		{
+#if defined(_MSC_VER)
+			return _xgetbv(0);
+#else
+			unsigned int low, high;
+			__asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+			return (uint64_t(high) << 32) | low;
+#endif
+		}
+#endif
+
+
+		RowKernels::InstructionSet& selected()
+		{
+			static RowKernels::InstructionSet instruction_set = RowKernels::supported();
+			return instruction_set;
+		}
+	}
+
+
+
+	RowKernels::InstructionSet RowKernels::supported()
+	{
+#if defined(KP_X86)
+		int info[4];
+		cpuid(0, info);
+		const int max_leaf = info[0];
+		if (max_leaf < 1)
+			return InstructionSet::scalar;
+
+		cpuid(1, info);
+		const bool sse4 = (info[2] >> 20) & 1;
+		const bool avx = (info[2] >> 28) & 1;
+		const bool xsave = (info[2] >> 27) & 1; // the operating system uses xsave, so XCR0 can be read
+		const uint64_t registers = xsave ? saved_registers() : 0;
+
+		bool avx2 = false, avx512 = false;
+		if (max_leaf >= 7)
+		{
+			cpuid(7, info);
+			avx2 = (info[1] >> 5) & 1;
+			avx512 = (info[1] >> 16) & 1;
+		}
+
+		if (avx512 && (registers & 0xe6) == 0xe6) // xmm, ymm, opmask and zmm registers
+			return InstructionSet::avx512;
+		if (avx && avx2 && (registers & 0x6) == 0x6) // xmm and ymm registers
+			return InstructionSet::avx2;
+		if (sse4)
+			return InstructionSet::sse4;
+#endif
+		return InstructionSet::scalar;
+	}
+
+
+	RowKernels::InstructionSet RowKernels::instruction_set()
+	{
+		return selected();
+	}
+
+
+	void RowKernels::set_instruction_set(const std::string& name)
+	{
+		InstructionSet instruction_set;
+		if (name == "scalar")
+			instruction_set = InstructionSet::scalar;
+		else if (name == "sse4")
+			instruction_set = InstructionSet::sse4;
+		else if (name == "avx2")
+			instruction_set = InstructionSet::avx2;
+		else if (name == "avx512")
+			instruction_set = InstructionSet::avx512;
+		else
+			throw std::invalid_argument("KP::RowKernels::set_instruction_set: No instruction set " + name + " exists");
+
+		if (instruction_set > supported())
+			throw std::invalid_argument("KP::RowKernels::set_instruction_set: The processor doesn't support " + name);
+		selected() = instruction_set;
+	}
+
+
+	const char* RowKernels::name(InstructionSet instruction_set)
+	{
+		switch (instruction_set)
+		{
+		case InstructionSet::sse4: return "SSE4.2";
+		case InstructionSet::avx2: return "AVX2";
+		case InstructionSet::avx512: return "AVX-512";
+		default: return "scalar";
+		}
+	}
+
+
+	void RowKernels::add_item(int64_t* profits, int64_t capacity, const Item& item, uint64_t* take)
+	{
+		switch (selected())
+		{
+#if defined(KP_X86)
+		case InstructionSet::sse4: add_item_sse4(profits, capacity, item.weight, item.value, take); break;
+		case InstructionSet::avx2: add_item_avx2(profits, capacity, item.weight, item.value, take); break;
+		case InstructionSet::avx512: add_item_avx512(profits, capacity, item.weight, item.value, take); break;
+#endif
+		default: add_item_scalar(profits, item.weight, capacity, item.weight, item.value, take); break;
+		}
+	}
+
+
+	void RowKernels::add_items(int64_t* profits, int64_t capacity, const Item& first, const Item& second)
+	{
+		switch (selected())
+		{
+#if defined(KP_X86)
+		case InstructionSet::sse4: add_items_sse4(profits, capacity, first, second); break;
+		case InstructionSet::avx2: add_items_avx2(profits, capacity, first, second); break;
+		case InstructionSet::avx512: add_items_avx512(profits, capacity, first, second); break;
+#endif
+		default: add_items_scalar(profits, std::min(first.weight, second.weight), capacity, first, second); break;
+		}
+	}
+
+
+	void RowKernels::shift_or(uint64_t* bits, size_t nb_words, int64_t shift, uint64_t* new_bits)
+	{
+		const size_t q = static_cast<size_t>(shift) / 64;
+		const unsigned r = static_cast<unsigned>(shift % 64);
+		switch (selected())
+		{
+#if defined(KP_X86)
+		case InstructionSet::sse4: shift_or_sse4(bits, nb_words, q, r, new_bits); break;
+		case InstructionSet::avx2: shift_or_avx2(bits, nb_words, q, r, new_bits); break;
+		case InstructionSet::avx512: shift_or_avx512(bits, nb_words, q, r, new_bits); break;
+#endif
+		default: shift_or_scalar(bits, q, nb_words, q, r, new_bits); break;
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+
+
+namespace KP
+{
+	void StronglyCorrelated::solve_core(size_t first, size_t last, int64_t k)
+	{
+		// The items before the core are in the knapsack, the items after the core are not.
+		// For every weight of the core items, store the best cardinality: the highest if k >= 0, the lowest otherwise.
+		int64_t fixed_weight = 0;
+		for (size_t j = 0; j < first; ++j)
+			fixed_weight += _items[j].weight;
+
+		int64_t core_weight = 0;
+		for (size_t j = first; j < last; ++j)
+			core_weight += _items[j].weight;
+
+		const int64_t range = std::min(_capacity - fixed_weight, core_weight);
+		auto better = [k](int a, int b) { return k >= 0 ? a > b : a < b; };
+
+		_cardinality.assign(range + 1, -1);
+		_last.assign(range + 1, -1);
+		_cardinality[0] = 0;
+		_trail.clear();
+
+		int64_t reach = 0; // highest weight that can be reachable
+		for (size_t j = first; j < last; ++j)
+		{
+			const int64_t weight = _items[j].weight;
+			if (weight > range)
+				continue;
+
+			// from high to low weights, so that every item is added at most once
+			reach = std::min(range, reach + weight);
+			for (int64_t w = reach; w >= weight; --w)
+			{
+				if (_cardinality[w - weight] < 0)
+					continue;
+
+				int cardinality = _cardinality[w - weight] + 1;
+				if (_cardinality[w] < 0 || better(cardinality, _cardinality[w]))
+				{
+					_cardinality[w] = cardinality;
+					_last[w] = _trail.add(static_cast<int>(j), _last[w - weight]);
+				}
+			}
+
+			if (_trail.needs_compaction())
+				_trail.compact(_last);
+		}
+
+		// best combination of weight and cardinality
+		int64_t best_weight = -1;
+		for (int64_t w = 0; w <= range; ++w)
+		{
+			if (_cardinality[w] < 0)
+				continue;
+
+			int64_t value = fixed_weight + w + k * static_cast<int64_t>(first + _cardinality[w]);
+			if (value > _best_value)
+			{
+				_best_value = value;
+				best_weight = w;
+			}
+		}
+
+		if (best_weight >= 0)
+		{
+			_output << "\nNew best solution found with z = " << _best_value;
+
+			_best_solution.assign(_items.size(), 0);
+			for (size_t j = 0; j < first; ++j)
+				_best_solution[j] = 1;
+			_trail.apply(_last[best_weight], _best_solution);
+		}
+	}
+
+
+	void StronglyCorrelated::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nDynamic programming over the weights and cardinalities for strongly correlated instances ...";
+		_output.set_on(verbose);
+
+		if (!is_strongly_correlated())
+			throw std::invalid_argument("KP::StronglyCorrelated::run: The value of every item should be equal to its weight plus the same constant");
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize
+		const size_t n = _items.size();
+		const int64_t k = n > 0 ? _items.front().value - _items.front().weight : 0;
+		_best_solution.assign(n, 0);
+		_best_value = 0;
+		_output << "\n\nValue = weight + " << k << " for every item";
+
+
+
+		// 1. sort the items from light to heavy
+		_output << "\n\nSorting the items from light to heavy";
+		std::sort(_items.begin(), _items.end(), [](const Item& a, const Item& b) { return a.weight < b.weight; });
+
+
+
+		// 2. at most b items fit in the knapsack: the b lightest items
+		size_t breakitem_index = 0;
+		int64_t weightsum = 0;
+		while (breakitem_index < n && weightsum + _items[breakitem_index].weight <= _capacity)
+			weightsum += _items[breakitem_index++].weight;
+
+		// the weight of c items is at most C and at most the weight of the c heaviest items
+		int64_t upper_bound = 0;
+		{
+			int64_t heaviest = 0;
+			for (size_t c = 1; c <= breakitem_index; ++c)
+			{
+				heaviest += _items[n - c].weight;
+				upper_bound = std::max(upper_bound, std::min(_capacity, heaviest) + k * static_cast<int64_t>(c));
+			}
+		}
+		_output << "\nAt most " << breakitem_index << " items fit in the knapsack"
+			<< "\nUpper bound: U = " << upper_bound;
+
+
+
+		// 3. dynamic programming over a core [first, last) around the break item, doubled until the bound is reached
+		size_t first = 0, last = 0;
+		for (size_t half = 16; _best_value < upper_bound && (first > 0 || last < n); half *= 2)
+		{
+			first = breakitem_index > half ? breakitem_index - half : 0;
+			last = std::min(n, breakitem_index + half);
+			_output << "\n\nCore = [" << first + 1 << ", " << last << "]";
+			solve_core(first, last, k);
+		}
+		_cardinality.clear();
+		_last.clear();
+		_trail.clear();
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nCore size: " << last - first
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in StronglyCorrelated: Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in StronglyCorrelated: Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+}
\ No newline at end of file
@@ -0,0 +1,496 @@
+#include "algorithms.h"
+#include <chrono>
+#include <stdexcept>
+#include <bit>
+#include <cmath>
+
+
+
+namespace KP
+{
+	void SubsetSum::reachable(size_t first, size_t last, int64_t capacity, std::vector<uint64_t>& bits) const
+	{
+		const size_t nb_words = static_cast<size_t>(capacity) / 64 + 1;
+		bits.assign(nb_words, 0);
+		bits[0] = 1;
+		int64_t reach = 0; // highest weight that can be reachable
+		for (size_t j = first; j < last; ++j)
+		{
+			if (_items[j].weight > capacity || _items[j].weight <= 0)
+				continue;
+			reach = std::min(capacity, reach + _items[j].weight);
+			RowKernels::shift_or(bits.data(), static_cast<size_t>(reach) / 64 + 1, _items[j].weight, nullptr);
+		}
+	}
+
+
+	void SubsetSum::recover_subset(size_t first, size_t last, int64_t target, std::vector<uint64_t>& forward, std::vector<uint64_t>& backward)
+	{
+		// the weights reachable with both halves of the items show how the target is divided, both halves are then
+		// solved with their part of the target
+		if (target == 0)
+			return;
+		if (last - first == 1)
+		{
+			_best_solution[first] = 1;
+			return;
+		}
+
+		size_t mid = first + (last - first) / 2;
+		reachable(first, mid, target, forward);
+		reachable(mid, last, target, backward);
+
+		int64_t c = 0;
+		while (!(forward[c / 64] >> (c % 64) & 1 && backward[(target - c) / 64] >> ((target - c) % 64) & 1))
+			++c;
+		_output << "\nItems " << first + 1 << " to " << last << " with weight " << target << ": weight "
+			<< c << " for items " << first + 1 << " to " << mid << ", " << target - c << " for items " << mid + 1 << " to " << last;
+
+		recover_subset(first, mid, c, forward, backward);
+		recover_subset(mid, last, target - c, forward, backward);
+	}
+
+
+	void SubsetSum::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nBit-parallel dynamic programming for the subset-sum problem ...";
+		_output.set_on(verbose);
+
+		if (!is_subset_sum())
+			throw std::invalid_argument("KP::SubsetSum::run: The value of every item should be equal to its weight");
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize: only weight 0 is reachable
+		const size_t nb_words = static_cast<size_t>(_capacity) / 64 + 1;
+		_reachable.assign(nb_words, 0);
+		_reachable[0] = 1;
+		_best_solution.assign(_items.size(), 0);
+		_output << "\n\nBitset of " << nb_words << " words for the weights 0 to " << _capacity;
+
+		// added[k] = the weights that are reached for the first time by the k-th added item, only stored if it fits in memory
+		size_t nb_candidates = 0;
+		for (auto&& item : _items)
+			if (item.weight <= _capacity && item.weight > 0)
+				++nb_candidates;
+		const bool store_decisions = nb_candidates * nb_words <= (size_t(1) << 25);
+		std::vector<uint64_t> added;
+		std::vector<size_t> added_items; // item of every row of 'added'
+		if (store_decisions)
+			added.assign(nb_candidates * nb_words, 0);
+
+
+
+		// 1. add the items one by one
+		int64_t reach = 0; // highest weight that can be reachable
+		size_t nb_added = 0;
+		size_t last = 0; // the items [0, last) have been considered
+		for (size_t j = 0; j < _items.size(); ++j)
+		{
+			last = j + 1;
+			if (_items[j].weight > _capacity || _items[j].weight <= 0)
+				continue;
+
+			// reachable |= reachable << w, weights above the capacity are not reachable
+			reach = std::min(_capacity, reach + _items[j].weight);
+			RowKernels::shift_or(_reachable.data(), static_cast<size_t>(reach) / 64 + 1, _items[j].weight, store_decisions ? &added[nb_added * nb_words] : nullptr);
+			if ((_capacity + 1) % 64 != 0)
+				_reachable.back() &= (uint64_t(1) << ((_capacity + 1) % 64)) - 1;
+			if (store_decisions)
+				added_items.push_back(j);
+			++nb_added;
+
+			_output << "\nItem " << j + 1 << " added";
+
+			if (_reachable.back() >> (_capacity % 64) & 1)
+			{
+				_output << "\nThe capacity can be filled completely";
+				break;
+			}
+		}
+
+
+
+		// 2. best reachable weight
+		_best_value = 0;
+		for (size_t i = nb_words; i-- > 0; )
+		{
+			if (_reachable[i] != 0)
+			{
+				_best_value = 64 * static_cast<int64_t>(i) + 63 - std::countl_zero(_reachable[i]);
+				break;
+			}
+		}
+
+
+
+		// 3. reconstruct solution: if weight c was reached for the first time by item j, weight c - w_j was reached before
+		if (store_decisions)
+		{
+			int64_t c = _best_value;
+			for (size_t k = nb_added; k-- > 0 && c > 0; )
+			{
+				if (added[k * nb_words + c / 64] >> (c % 64) & 1)
+				{
+					_best_solution[added_items[k]] = 1;
+					c -= _items[added_items[k]].weight;
+				}
+			}
+		}
+		else
+		{
+			_output << "\n\nThe first weights of the items don't fit in memory: recovering the solution by divide and conquer";
+			std::vector<uint64_t> forward, backward;
+			recover_subset(0, last, _best_value, forward, backward);
+		}
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nItems added: " << nb_added
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in SubsetSum: Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in SubsetSum: Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	// Number-theoretic transform modulo p = 15 * 2^27 + 1, which has primitive root 31 and supports lengths up to 2^27
+	static const uint32_t ntt_modulus = 2013265921;
+	static const uint32_t ntt_root = 31;
+	static const size_t ntt_max_length = size_t(1) << 27;
+
+	static uint32_t power_mod(uint64_t base, uint64_t exponent)
+	{
+		uint64_t result = 1;
+		base %= ntt_modulus;
+		while (exponent > 0)
+		{
+			if (exponent & 1)
+				result = result * base % ntt_modulus;
+			base = base * base % ntt_modulus;
+			exponent >>= 1;
+		}
+		return static_cast<uint32_t>(result);
+	}
+
+	// The inverse transform is not divided by the length: only the nonzero coefficients are of interest
+	static void ntt(std::vector<uint32_t>& a, bool inverse)
+	{
+		const size_t n = a.size();
+
+		// roots of unity for every level: [h + k] = w_{2h}^k
+		static std::vector<uint32_t> roots;
+		if (roots.size() < n)
+		{
+			roots.assign(n, 1);
+			for (size_t h = 1; h < n; h <<= 1)
+			{
+				uint32_t w = power_mod(ntt_root, (ntt_modulus - 1) / (2 * h));
+				for (size_t k = 1; k < h; ++k)
+					roots[h + k] = static_cast<uint32_t>(static_cast<uint64_t>(roots[h + k - 1]) * w % ntt_modulus);
+			}
+		}
+
+		// bit reversal permutation
+		for (size_t i = 1, j = 0; i < n; ++i)
+		{
+			size_t bit = n >> 1;
+			for (; j & bit; bit >>= 1)
+				j ^= bit;
+			j ^= bit;
+			if (i < j)
+				std::swap(a[i], a[j]);
+		}
+
+		for (size_t h = 1; h < n; h <<= 1)
+		{
+			const uint32_t* w = roots.data() + h;
+			for (size_t i = 0; i < n; i += 2 * h)
+			{
+				for (size_t k = 0; k < h; ++k)
+				{
+					uint32_t u = a[i + k];
+					uint32_t v = static_cast<uint32_t>(static_cast<uint64_t>(a[i + k + h]) * w[k] % ntt_modulus);
+					a[i + k] = u + v >= ntt_modulus ? u + v - ntt_modulus : u + v;
+					a[i + k + h] = u >= v ? u - v : u + ntt_modulus - v;
+				}
+			}
+		}
+
+		// the inverse transform is the forward transform with the roots inverted, i.e. with the outputs 1 .. n-1 reversed
+		if (inverse)
+			std::reverse(a.begin() + 1, a.end());
+	}
+
+	// dst |= src << shift, truncated to the size of dst
+	static void or_shifted(std::vector<uint64_t>& dst, const std::vector<uint64_t>& src, int64_t shift)
+	{
+		const size_t q = shift / 64;
+		const unsigned r = shift % 64;
+		const size_t last = std::min(dst.size(), src.size() + q + 1);
+		for (size_t i = q; i < last; ++i)
+		{
+			size_t k = i - q;
+			uint64_t x = k < src.size() ? src[k] << r : 0;
+			if (r != 0 && k >= 1)
+				x |= src[k - 1] >> (64 - r);
+			dst[i] |= x;
+		}
+	}
+
+	static size_t popcount(const std::vector<uint64_t>& bits)
+	{
+		size_t count = 0;
+		for (auto&& word : bits)
+			count += std::popcount(word);
+		return count;
+	}
+
+	///////////////////////////////////////////////////////////////////////////
+
+	void SubsetSumFFT::sumset(Node& node)
+	{
+		const Node& a = _nodes[node.left];
+		const Node& b = _nodes[node.right];
+
+		node.size = std::min(_capacity, a.size + b.size);
+		node.reachable.assign(node.size / 64 + 1, 0);
+
+		size_t length = 1;
+		while (length < static_cast<size_t>(a.size + b.size + 1))
+			length <<= 1;
+
+		// shift-OR the larger set for every weight of the smaller set, if this is cheaper than the transforms
+		size_t count_a = popcount(a.reachable), count_b = popcount(b.reachable);
+		const Node& small = count_a < count_b ? a : b;
+		const Node& large = count_a < count_b ? b : a;
+		double direct_cost = static_cast<double>(std::min(count_a, count_b)) * node.reachable.size();
+		double transform_cost = 8.0 * length * std::log2(static_cast<double>(length));
+
+		if (direct_cost <= transform_cost)
+		{
+			for (size_t i = 0; i < small.reachable.size(); ++i)
+				for (uint64_t word = small.reachable[i]; word != 0; word &= word - 1)
+					or_shifted(node.reachable, large.reachable, 64 * static_cast<int64_t>(i) + std::countr_zero(word));
+		}
+		else
+		{
+			if (length > ntt_max_length)
+				throw std::invalid_argument("KP::SubsetSumFFT::sumset: Capacity too large for the number-theoretic transform");
+
+			std::vector<uint32_t> fa(length, 0), fb(length, 0);
+			for (int64_t c = 0; c <= a.size; ++c)
+				fa[c] = (a.reachable[c / 64] >> (c % 64)) & 1;
+			for (int64_t c = 0; c <= b.size; ++c)
+				fb[c] = (b.reachable[c / 64] >> (c % 64)) & 1;
+
+			ntt(fa, false);
+			ntt(fb, false);
+			for (size_t k = 0; k < length; ++k)
+				fa[k] = static_cast<uint32_t>(static_cast<uint64_t>(fa[k]) * fb[k] % ntt_modulus);
+			ntt(fa, true);
+			_nb_transforms += 3;
+
+			// the number of ways to reach weight c is below the modulus, so nonzero means reachable
+			for (int64_t c = 0; c <= node.size; ++c)
+				if (fa[c] != 0)
+					node.reachable[c / 64] |= uint64_t(1) << (c % 64);
+		}
+
+		if ((node.size + 1) % 64 != 0)
+			node.reachable.back() &= (uint64_t(1) << ((node.size + 1) % 64)) - 1;
+
+		_output << "\nSumset of " << a.size << " and " << b.size << " up to " << node.size
+			<< (direct_cost <= transform_cost ? " with shift-OR" : " with the number-theoretic transform");
+	}
+
+
+	int SubsetSumFFT::build(const std::vector<std::vector<int>>& groups, size_t first, size_t last)
+	{
+		int index = static_cast<int>(_nodes.size());
+		_nodes.emplace_back();
+
+		if (last - first == 1) // leaf: the weights {0, w, 2w, ...}
+		{
+			Node& leaf = _nodes[index];
+			leaf.items = groups[first];
+			int64_t weight = _items[leaf.items.front()].weight;
+			int64_t copies = std::min<int64_t>(leaf.items.size(), _capacity / weight);
+			leaf.size = copies * weight;
+			leaf.reachable.assign(leaf.size / 64 + 1, 0);
+			for (int64_t k = 0; k <= copies; ++k)
+				leaf.reachable[k * weight / 64] |= uint64_t(1) << (k * weight % 64);
+			return index;
+		}
+
+		size_t middle = (first + last) / 2;
+		int left = build(groups, first, middle);
+		int right = build(groups, middle, last);
+		_nodes[index].left = left;
+		_nodes[index].right = right;
+		sumset(_nodes[index]);
+		return index;
+	}
+
+
+	void SubsetSumFFT::reconstruct(int node, int64_t c)
+	{
+		const Node& current = _nodes[node];
+		if (current.left < 0)
+		{
+			int64_t copies = c / _items[current.items.front()].weight;
+			for (int64_t k = 0; k < copies; ++k)
+				_best_solution[current.items[k]] = 1;
+			return;
+		}
+
+		// find a weight x of the left set such that c - x is in the right set
+		const Node& a = _nodes[current.left];
+		const Node& b = _nodes[current.right];
+		for (size_t i = 0; i < a.reachable.size(); ++i)
+		{
+			for (uint64_t word = a.reachable[i]; word != 0; word &= word - 1)
+			{
+				int64_t x = 64 * static_cast<int64_t>(i) + std::countr_zero(word);
+				if (x > c)
+					return;
+				if (c - x <= b.size && (b.reachable[(c - x) / 64] >> ((c - x) % 64) & 1))
+				{
+					reconstruct(current.left, x);
+					reconstruct(current.right, c - x);
+					return;
+				}
+			}
+		}
+	}
+
+
+	void SubsetSumFFT::run(bool verbose)
+	{
+		_output.set_on(true);
+		_output << "\n\n\nDivide and conquer with number-theoretic transforms for the subset-sum problem ...";
+		_output.set_on(verbose);
+
+		if (!is_subset_sum())
+			throw std::invalid_argument("KP::SubsetSumFFT::run: The value of every item should be equal to its weight");
+
+		auto start_time = std::chrono::system_clock::now();
+		std::chrono::duration<double, std::ratio<1, 1>> elapsed_time;
+
+
+
+		// Initialize
+		_nodes.clear();
+		_nb_transforms = 0;
+		_best_solution.assign(_items.size(), 0);
+		_best_value = 0;
+
+
+
+		// 1. group the items by weight
+		std::vector<int> order;
+		for (size_t j = 0; j < _items.size(); ++j)
+			if (_items[j].weight > 0 && _items[j].weight <= _capacity)
+				order.push_back(static_cast<int>(j));
+		std::sort(order.begin(), order.end(), [this](int a, int b) { return _items[a].weight < _items[b].weight; });
+
+		std::vector<std::vector<int>> groups;
+		for (size_t k = 0; k < order.size(); ++k)
+		{
+			if (k == 0 || _items[order[k]].weight != _items[order[k - 1]].weight)
+				groups.push_back(std::vector<int>());
+			groups.back().push_back(order[k]);
+		}
+		_output << "\n\nNumber of distinct weights: " << groups.size();
+
+
+
+		// 2. divide and conquer over the groups
+		if (!groups.empty())
+		{
+			int root = build(groups, 0, groups.size());
+
+			for (size_t i = _nodes[root].reachable.size(); i-- > 0; )
+			{
+				if (_nodes[root].reachable[i] != 0)
+				{
+					_best_value = 64 * static_cast<int64_t>(i) + 63 - std::countl_zero(_nodes[root].reachable[i]);
+					break;
+				}
+			}
+
+			// 3. reconstruct solution
+			reconstruct(root, _best_value);
+		}
+
+
+
+		// Output
+		elapsed_time = std::chrono::system_clock::now() - start_time;
+		_output.set_on(true);
+		_output << "\n\n\nComputation time (s): " << elapsed_time.count()
+			<< "\nNumber of transforms: " << _nb_transforms
+			<< "\nOptimal solution: z = " << _best_value << "\n";
+		if (_items.size() <= 10) {
+			for (size_t i = 0; i < _items.size(); ++i) {
+				if (_best_solution[i] == 1) {
+					_output << "Item " << _items[i].number + 1 << "  ";
+				}
+			}
+		}
+
+
+		// Check
+		{
+			int64_t Ps = 0, Ws = 0;
+			for (size_t i = 0; i < _items.size(); ++i)
+			{
+				if (_best_solution[i] == 1)
+				{
+					Ps += _items[i].value;
+					Ws += _items[i].weight;
+				}
+			}
+			if (Ws > _capacity)
+				_output << "\nError in SubsetSumFFT: Weight " << Ws << " exceeds capacity " << _capacity;
+			else if (Ps != _best_value)
+				_output << "\nError in SubsetSumFFT: Value " << Ps << " not equal to best lower bound " << _best_value;
+			else
+				_output << "\nCheck OK";
+		}
+	}
+
+}
\ No newline at end of file
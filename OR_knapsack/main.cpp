@@ -15,13 +15,37 @@ int main(int argc, char* argv[])
 		options.add_options()
 			("algorithm", "The choice of algorithm. Possibilities:"
 				"\n\t* \"CE\": complete enumeration"
+				"\n\t* \"MITM\": complete enumeration with the meet-in-the-middle method of Horowitz and Sahni"
+				"\n\t* \"SCH\": complete enumeration with the method of Schroeppel and Shamir, using less memory than MITM"
+				"\n\t* \"GC\": complete enumeration in Gray-code order, in parallel"
 				"\n\t* \"IP\": an integer programming model solved with SCIP"
 				"\n\t* \"BB\": the standard branch-and-bound approach of Winston"
+				"\n\t* \"BF\": the branch-and-bound approach of Winston with best-first node selection, depth-first if the memory limit is reached"
+				"\n\t* \"HS\": the depth-first branch-and-bound method of Horowitz and Sahni"
 				"\n\t* \"PI\": the branch-and-bound approach of Pisinger"
+				"\n\t* \"EX\": the branch-and-bound approach of Pisinger with an expanding core (expknap)"
+				"\n\t* \"MT2\": the branch-and-bound algorithm MT2 of Martello and Toth, with core, reduction and bound U2"
+				"\n\t* \"MK\": the expanding core dynamic programming algorithm of Pisinger (minknap)"
+				"\n\t* \"CO\": the combo algorithm of Martello, Pisinger and Toth"
 				"\n\t* \"DP1\": dynamic programming with a stage for every item"
+				"\n\t* \"DP1R\": dynamic programming with a stage for every item and only one row of states,"
+				" the solution is recovered by divide and conquer (Hirschberg)"
 				"\n\t* \"DP2\": dynamic programming with a stage for every possible residual capacity"
+				"\n\t* \"DP3\": dynamic programming with a stage for every item and states for the profit"
+				"\n\t* \"DP\": dynamic programming over the capacity or over the profits, whichever range is smallest"
+				"\n\t* \"NU\": dynamic programming of Nemhauser and Ullmann with only the undominated states"
+				"\n\t* \"BAL\": balanced dynamic programming of Pisinger, starting from the break solution"
+				"\n\t* \"SC\": dynamic programming over the weights and cardinalities for strongly correlated instances"
+				" (value == weight + constant), also used instead of DP for these instances"
+				"\n\t* \"SS\": bit-parallel dynamic programming for subset-sum instances (value == weight),"
+				" also used instead of DP1 and DP2 for these instances"
+				"\n\t* \"SSFFT\": divide and conquer with number-theoretic transforms for subset-sum instances with a large capacity"
 				, cxxopts::value<std::string>())
 			("data", "Name of the file containing the problem data", cxxopts::value<std::string>())
+			("memory", "Memory limit (MB) for the open nodes of the best-first branch-and-bound (default 1024)", cxxopts::value<size_t>())
+			("threads", "Number of threads for the depth-first branch-and-bound (BB), the branch-and-bound of Pisinger (PI) and the Gray-code enumeration (GC), 0 = all processor cores (default 1, all processor cores for GC)", cxxopts::value<size_t>())
+			("split-depth", "Depth of the subproblems that are distributed over the threads in PI (default 4)", cxxopts::value<size_t>())
+			("simd", "Instruction set for the row updates of the dynamic programs over the capacity: scalar, sse4, avx2 or avx512 (default: the widest one of the processor)", cxxopts::value<std::string>())
 			("verbose", "Explain the various steps of the algorithm", cxxopts::value<bool>())
 			("help", "Help on how to use the application");
 
@@ -50,9 +74,33 @@ int main(int argc, char* argv[])
 
 
 
+		if (result.count("simd"))
+			KP::RowKernels::set_instruction_set(result["simd"].as<std::string>());
+
+
+
+
 		// create the algorithm and run it
-		std::unique_ptr<KP::Algorithm> problem = KP::AlgorithmFactory::create(algorithm);
-		problem->read_data(datafile);
+		std::unique_ptr<KP::Algorithm> problem = KP::AlgorithmFactory::create(algorithm, datafile);
+		if (result.count("memory"))
+		{
+			if (auto bb = dynamic_cast<KP::BranchAndBound*>(problem.get()))
+				bb->set_memory_limit(result["memory"].as<size_t>() << 20);
+		}
+		if (result.count("threads"))
+		{
+			if (auto bb = dynamic_cast<KP::BranchAndBound*>(problem.get()))
+				bb->set_threads(result["threads"].as<size_t>());
+			if (auto pi = dynamic_cast<KP::PisingerBB*>(problem.get()))
+				pi->set_threads(result["threads"].as<size_t>());
+			if (auto enumeration = dynamic_cast<KP::CompleteEnumeration*>(problem.get()))
+				enumeration->set_threads(result["threads"].as<size_t>());
+		}
+		if (result.count("split-depth"))
+		{
+			if (auto pi = dynamic_cast<KP::PisingerBB*>(problem.get()))
+				pi->set_split_depth(result["split-depth"].as<size_t>());
+		}
 		problem->run(verbose);
 
 